@@ -0,0 +1,125 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: AltLocCombinations.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definition for walking through the alternate location combinations
+//               of a ring without building all of them
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __ALTLOCCOMBINATIONS_HPP__
+#define __ALTLOCCOMBINATIONS_HPP__
+
+#include <vector>
+#include <string>
+#include "Atom.hpp"
+
+using namespace std;
+
+// Combinations up to this many are built up front.  Past that, only the
+// combinations that are the closest to some partner are built
+#define ALTLOC_EAGER_LIMIT 16
+
+// Most combinations that will be built for a residue past the ones above
+#define ALTLOC_BUILT_CAP 64
+
+// A center made as a weighted average over a number of slots (one per
+// ring atom), where each slot can be filled by any of the alternate
+// locations of its atom.  The combinations are counted like an
+// odometer with the last slot turning the fastest, which is the order
+// the nested loops of the center functions went in
+class AltLocCombinations
+{
+public:
+  // Constructor that starts off with no slots
+  AltLocCombinations();
+
+  // Adds a slot with the atoms that can fill it and their weight
+  void addSlot(const vector<Atom*>& options, float weight);
+
+  // Removes all of the slots
+  void clear();
+
+  // True if there are no slots
+  bool empty() const;
+
+  // Number of combinations (as a double since it can get big)
+  double count() const;
+
+  // Sets choice to the first combination
+  void first(vector<unsigned int>& choice) const;
+
+  // Moves choice on to the next combination.  Returns false once
+  // every combination has been seen
+  bool next(vector<unsigned int>& choice) const;
+
+  // Builds the center of a combination.  plane_info gets the atoms of
+  // the slots listed in planeSlots, and altLoc gets the altLoc of every
+  // slot in order
+  void build(const vector<unsigned int>& choice, Coordinates* center) const;
+
+  // The combination that follows alternate location id wherever it can:
+  // the atom with that id, or else the one without an id, or else the
+  // first one
+  void follow(char id, vector<unsigned int>& choice) const;
+
+  // Finds the combination whose center is closest to target and closer
+  // than limit, by branch and bound: with some slots filled in, the
+  // center can only be in the box that the rest of the slots span, and
+  // the branch is dropped as soon as that box is further away than the
+  // best one so far.  Returns false if nothing is closer than limit
+  bool closest(const Coordinates& target, float limit, vector<unsigned int>& choice) const;
+
+  // No combination is further than this from any other
+  float spread() const;
+
+  vector< vector<Atom*> > slots;      // Atoms that can fill each slot
+  vector<float>           weights;    // Weight of each slot
+  float                   divisor;    // What the weighted sum is divided by
+  vector<unsigned int>    planeSlots; // Slots that go in plane_info, in order
+
+private:
+  // One level of closest()
+  void search(unsigned int slot,
+              const Coordinates& sum,
+              const Coordinates& target,
+              vector<unsigned int>& current,
+              float* best2,
+              vector<unsigned int>& choice,
+              bool* found) const;
+
+  // Per slot boxes of weight * coordinates, summed from each slot to
+  // the last one
+  vector<Coordinates> lowerRest, upperRest;
+};
+
+#endif
@@ -43,7 +43,11 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <utility>
 #include "Atom.hpp"
+#include "Plane.hpp"
+#include "AltLocCombinations.hpp"
+#include "ResidueTable.hpp"
 
 // This is just because I was dumb before and just called this library
 // AminoAcid, whereas it should have been Residue.  I just don't
@@ -72,68 +76,18 @@
 
 class AminoAcid{
 private:
-  // calculates the centers of the AA and sets the plane
-  // information order to calculate the angle later
-  void centerPHEorTYR();
-  void centerTRP();
-
-  // Calculates the CM of PHE using alternate locations
-  void centerPHEorTYR_altloc();
-
-  // Calculates the center of mass for the PO4, 2HP, and PI ligands
-  //void centerPO4();
-  void centerPO4or2HPorPI();
-  // and the center of charge of PO4, 2HP, and PI ligands
-  //void centerPO4();
-  void centerPO4or2HPorPI_charge();
-
-  // Calculates the center of mass for the 2PO and PO3 ligands
-  void center2POorPO3();
-  // and the center of charge of 2PO and PO3 ligands
-  void center2POorPO3_charge();
-
-  // DO NOT USE THESE!!!! If you use this, puppies will be harmed!
-  // This is only here for legacy reasons because this is what the old
-  // STAAR code used.  It is wrong.
-  void centerASP();
-  void centerGLU();
-
-  // These find the oxygens that will later be used for distances for ASP and GLU
-  void centerASP_oxygen();
-  void centerASP_oxygen_altloc();
-  void centerGLU_oxygen();
-  void centerGLU_oxygen_altloc();
-
-  void centerPHEorTYR_simplified();
-  void centerASP_charge();
-  void centerGLU_charge();
-
-  void printPHEorTYR(FILE* output);
-  void printASP(FILE* output);
-  void printGLU(FILE* output);
-
-  // These functions mark the alternate locations of the atoms that were
-  // not used in the calculation of the center of mass
-  void markAltLocAtomsPHEorTYR(int index);
-  void markAltLocAtomsASP(int index);
-  void markAltLocAtomsGLU(int index);
-  void markAltLocAtomsPO4or2HPorPI(int index);
-  void markAltLocAtoms2POorPO3(int index);
-
-  void unmarkAltLocAtomsPHEorTYR();
-  void unmarkAltLocAtomsASP();
-  void unmarkAltLocAtomsGLU();
-  void unmarkAltLocAtomsPO4or2HPorPI();
-  void unmarkAltLocAtoms2POorPO3();
-
-  string makeConectPHEorTYR();
-  string makeConectPHEorTYR_altloc(int c);
-  string makeConectASP();
-  string makeConectASP_altloc(int c);
-  string makeConectGLU();
-  string makeConectGLU_altloc(int c);
-  string makeConectPO4or2HPorPI();
-  string makeConect2POorPO3();
+  // Sorts the atoms into the slots of a table entry
+  bool matchSlots(const ResidueDescriptor* d,
+                  vector< vector<Atom*> >& slots,
+                  bool flagUnused);
+
+  // Calculates the centers and the center of charge the way the table
+  // entry of the residue says to
+  void centerFromTable(const ResidueDescriptor* d);
+  void chargeCenterFromTable(const ResidueEntry* e);
+
+  // Builds the ring centers from the alternate location combinations
+  void buildCombinations(AltLocCombinations& all);
 
 public:
   // constructor
@@ -142,48 +96,65 @@ public:
   // destructor
   ~AminoAcid();
 
-  // Finds the alternate locations
+  // Finds the alternate locations and sets the altLocMask of every atom
   void determineAltLoc(vector<char>&altloc_ids);
 
+  // Number of conformers, the id of one, and whether an atom is part
+  // of one.  These only read, so the same residue can be looked at
+  // from several places at once
+  unsigned int conformers() const;
+  char conformerId(unsigned int c) const;
+  bool inConformer(const Atom* a, unsigned int c) const;
+
   // calculate the center of the AA. Calls the individual
   // functions above depending on AA
   void calculateCenter(bool center);
 
-  void calculateAnglesPreHydrogens(AminoAcid aa2,
+  // Picks the representative atom and its padding so the centers
+  // can be put off until a partner is known to be in reach
+  void setRepresentative();
+
+  // Calculates the centers if they have been put off until now
+  void ensureCenter();
+
+  // Works out the plane of every center from its plane_info atoms
+  void calculatePlanes();
+
+  // For rings with too many alternate location combinations to build
+  // up front: builds the combination closest to each target if it is
+  // within limit and closer than the centers there already are
+  void addClosestCombinations(const vector<Coordinates>& targets, float limit);
+
+  void calculateAnglesPreHydrogens(AminoAcid& aa2,
                                    int index1,
                                    int index2,
                                    float* angle,
                                    float* angle1,
                                    float* angleP);
-  bool calculateDistancesAndAnglesPostHydrogens(AminoAcid aa2,
-                                                Coordinates closestOxygen,
-                                                float threshold,
-                                                float* dist,
-                                                float* distOxy,
-                                                float* distOxy2,
-                                                float* angle,
-                                                float* angle1,
-                                                float* angleP);
 
   // Prints out only the atoms that we need to create benzene or formate
   void printNeededAtoms(FILE* output);
 
-  // Marks alt loc atoms that aren't used for center calculations
-  void markAltLocAtoms(int index);
+  // The atoms of conformer c that Babel is given
+  void conformerAtoms(int c, vector<Atom*>& given);
 
-  // Unmarks alt loc atoms that aren't used for center calculations
-  // Needed so that coordinates aren't invalid when they are 
-  // looked at as a different pair
-  void unmarkAltLocAtoms();
+  // The same for a residue whose centers are alternate location
+  // combinations (CENTER_COMBINATIONS): the atoms center c was built
+  // from, which need not all be from one conformer
+  void combinationAtoms(unsigned int c, vector<Atom*>& given);
 
-  // Make CONECT lines.  This avoids mono/di-atomic molecules
-  string makeConect(int c);
+  // Where the center of charge of the atoms given can be once the
+  // hydrogens are in: no further than *radius from *point.  Returns
+  // false if that depends on where the hydrogens go
+  bool chargeCenterBound(const vector<Atom*>& given, Coordinates* point, float* radius);
 
-  // Fix to remove excess hydrogens that Babel sometimes adds
-  // to the GLU and ASP residues
-  bool removeExcessHydrogens(vector<string> conect);
+  // Bonds between the atoms given from the table entry, as indices
+  // into given.  This avoids mono/di-atomic molecules
+  void tableBonds(const vector<Atom*>& given, vector<pair<int,int> >& bonds);
 
-  vector< vector<Atom*> > altlocs;
+  // Alternate location ids in the order they were found.  Conformer c
+  // is made of the atoms with bit c of their altLocMask set
+  vector<char> altlocIds;
 
   // this holds pointers to the ATOM strings
   vector<Atom*> atom;
@@ -191,6 +162,10 @@ public:
   // holds the calculated centers that will be examined
   vector<Coordinates>  center;
 
+  // the plane going through each center: the ring for the aromatics
+  // and the C/O/O plane for the anions
+  vector<Plane>        plane;
+
   // holds the residue name
   string residue;
 
@@ -200,7 +175,22 @@ public:
   // true if there is an alt loc in ATOM line
   bool altLoc;
 
-  bool corrected;
+  // false while the centers have not been calculated yet
+  bool centered;
+
+  // Atom standing in for the residue before the centers are calculated
+  // (CB, or CG for the aromatics and ASP, CD for GLU) and the largest
+  // distance from it to any atom the centers are made of.  No center
+  // can be further than pad away from the representative atom
+  Atom* representative;
+  float pad;
+
+  // Alternate location combinations that have not all been built, how
+  // far any of them can be from the centers that were, and how many
+  // have been built since
+  AltLocCombinations combinations;
+  float spread;
+  unsigned int built;
 
   string line;
 
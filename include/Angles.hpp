@@ -0,0 +1,102 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Angles.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definition for working out the angles of many residue pairs at
+//               once with packed instructions
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __ANGLES_HPP__
+#define __ANGLES_HPP__
+
+#include <vector>
+#include "AminoAcid.hpp"
+
+using namespace std;
+
+// Queues up center pairs and works out the three angles that
+// calculateAnglesPreHydrogens reports (angle, angle1, and angleP) for
+// all of them in a single pass.  Everything is kept one array per
+// coordinate so the dot products, norms, and arccosines can be done
+// several pairs at a time
+class AngleBatch
+{
+public:
+  // Constructor that starts off empty
+  AngleBatch();
+
+  // Queues center index1 of the aromatic a against center index2 of b.
+  // Both centers need their planes.  Returns the index of the pair
+  unsigned int add(AminoAcid& a, AminoAcid& b, int index1, int index2);
+
+  // Same as above, from the pieces themselves: the ring plane, the ring
+  // center, the CG atom, the anion center, and the anion plane
+  unsigned int add(const Plane& ring,
+                   const Coordinates& center1,
+                   const Coordinates& cg,
+                   const Coordinates& center2,
+                   const Plane& anion);
+
+  // Works out the angles of every queued pair.  The results go in
+  // angle, angle1, and angleP, with 1000 wherever a cosine came out
+  // outside of -1 and 1
+  void run();
+
+  // Empties the batch
+  void clear();
+
+  // Number of pairs queued
+  unsigned int size() const;
+
+  vector<float> angle;          // Angle between the ring plane and the line between the centers
+  vector<float> angle1;         // Angle between CG and the projected anion center
+  vector<float> angleP;         // Angle between the two planes
+
+private:
+  vector<float> nx, ny, nz, d;  // Ring plane
+  vector<float> cx, cy, cz;     // Ring center
+  vector<float> gx, gy, gz;     // CG atom
+  vector<float> px, py, pz;     // Anion center
+  vector<float> mx, my, mz;     // Anion plane normal
+  vector<float> cosine;         // Cosines of all three angles, one after the other
+};
+
+// Name of the instruction set the angle kernels picked (avx2, sse, or scalar)
+const char* angleKernelName();
+
+// Arccosine in radians of the n values of x, which must lie within -1
+// and 1, with the same kernel and polynomial AngleBatch uses.  x and y
+// may be the same array.  scripts/checkAngles.d measures its error
+void arccosBatch(const float* x, unsigned int n, float* y);
+
+#endif
@@ -71,6 +71,19 @@
 // #define CHARGE_H2_P4O CHARGE_H1_2PO
 // #define CHARGE_H3_P4O CHARGE_H1_2PO 
 
+// How the alternate locations of a residue are read in: all of them,
+// only the first one in the file, or only the one with the highest
+// occupancy
+#define CONFORMER_ALL                0
+#define CONFORMER_FIRST              1
+#define CONFORMER_HIGHEST_OCCUPANCY  2
+
+// An atom's altLocMask has bit c set if it belongs to conformer c of
+// its residue.  Atoms without an alternate location belong to all of
+// them, so a residue can have at most MAX_ALTLOCS conformers
+#define ALTLOC_MASK_ALL 0xFFFFFFFFu
+#define MAX_ALTLOCS     32
+
 class Atom
 {
 private:
@@ -86,6 +99,8 @@ public:
   ~Atom();
   // Parses an ATOM or HETATM line
   void parseAtom(string line, int num);
+  // Moves the atom and rewrites the coordinate columns of the line
+  void setCoordinates(const Coordinates& c);
   // Prints out all the values space delimited
   void print();
   // Prints out atom in pdb format to the given FILE*
@@ -109,6 +124,9 @@ public:
 
   bool skip;
 
+  // Conformers of the residue this atom is part of (see ALTLOC_MASK_ALL)
+  unsigned int altLocMask;
+
   string line;
 
   friend ostream& operator<<(ostream& output, const Atom& p);
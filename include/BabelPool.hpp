@@ -0,0 +1,170 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: BabelPool.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Runs Babel's AddHydrogens on batches of residues, either in this process
+//               or in a pool of worker processes that are restarted if they crash or hang
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __BABELPOOL_HPP__
+#define __BABELPOOL_HPP__
+
+#include <vector>
+#include <string>
+#include <sys/types.h>
+#include "AminoAcid.hpp"
+
+using namespace std;
+
+// How long a worker gets for a batch by default, in seconds
+#define BABEL_WORKER_TIMEOUT 120
+
+// Element symbol of an atom, taken from its name when the element
+// column is blank the way Babel does
+string elementSymbol(const Atom& a);
+
+// An atom of a batch, with only what Babel is told about it
+class BatchAtom
+{
+public:
+  char  element[2];             // Element symbol, padded with a blank
+  char  name[4];                // Atom name, as in columns 13-16
+  bool  het;                    // True for HETATM records
+  float x, y, z;
+};
+
+// A residue of a batch: atoms [first, first + count) and bonds
+// [firstBond, firstBond + bonds), which index its own atoms
+class BatchFragment
+{
+public:
+  char         residue[3];      // Residue name
+  char         chain;
+  int          resSeq;
+  unsigned int first;
+  unsigned int count;
+  unsigned int firstBond;
+  unsigned int bonds;
+};
+
+// Residues to protonate, each a molecule fragment of its own.  This is
+// all that goes to a worker, so it is kept to plain numbers
+class HydrogenBatch
+{
+public:
+  // Adds the atoms given of r and the bonds of its table entry
+  void addFragment(AminoAcid& r, const vector<Atom*>& given);
+
+  // Empties the batch
+  void clear();
+
+  vector<BatchFragment> fragments;
+  vector<BatchAtom>     atoms;
+  vector<unsigned int>  bonds;     // Pairs of atom indices within the fragment
+};
+
+// A hydrogen Babel added: the fragment, the atom of it the hydrogen is
+// on, and where it is
+class AddedHydrogen
+{
+public:
+  unsigned int fragment;
+  unsigned int parent;
+  float        x, y, z;
+};
+
+// Runs Babel on batch in this process, filling added with the
+// hydrogens in the order Babel appended them.  Babel is loaded the
+// first time this is called
+void protonateBatch(const HydrogenBatch& batch, vector<AddedHydrogen>& added);
+
+// Seconds it took to load Babel in this process, or a negative number
+// if no batch has needed it yet
+double babelLoadTime();
+
+// A worker process and the pipes to it
+class BabelWorker
+{
+public:
+  pid_t pid;
+  int   request;                // Write end of the pipe to the worker
+  int   reply;                  // Read end of the pipe from the worker
+};
+
+// Worker processes that each run protonateBatch on what is sent to them
+// over a pipe.  The requests and replies are the batches and the added
+// hydrogens written out as raw numbers (see BabelPool.cpp).  Babel never
+// runs in the main process, so if it crashes or hangs only the worker
+// is lost: it is killed, started again, and the batch is reported as
+// failed.  One found gone when a batch is sent to it is started again
+// and gets the batch once more
+class BabelPool
+{
+public:
+  // Constructor that starts no workers
+  BabelPool();
+  // Stops the workers
+  ~BabelPool();
+
+  // Starts n workers.  Returns false if they could not be started
+  bool start(unsigned int n, unsigned int timeout);
+
+  // Stops the workers and waits for them to exit
+  void stop();
+
+  // Number of workers running
+  unsigned int size() const;
+
+  // Runs batches[i] on a worker, as many at the same time as there are
+  // workers.  ok[i] is false if its worker crashed or timed out, or if
+  // it could not be sent to a new worker either
+  void run(const vector<HydrogenBatch>& batches,
+           vector< vector<AddedHydrogen> >& added,
+           vector<bool>& ok);
+
+  unsigned int restarts;        // Workers that had to be started again
+  unsigned int loads;           // Workers that loaded Babel,
+  double       loadTime;        //   and the seconds they took all together
+
+private:
+  // Forks worker i
+  bool spawn(unsigned int i);
+
+  // Kills worker i and starts it again
+  void restart(unsigned int i, const char* why);
+
+  vector<BabelWorker> workers;
+  unsigned int        timeout;  // Seconds a worker gets for a batch
+};
+
+#endif
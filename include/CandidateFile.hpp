@@ -0,0 +1,138 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: CandidateFile.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definitions for the file of candidate pairs written by the
+//               search and read back to add the hydrogens
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __CANDIDATEFILE_HPP__
+#define __CANDIDATEFILE_HPP__
+
+#include <vector>
+#include <deque>
+#include <string>
+#include "../gzstream/gzstream.h"
+#include "AminoAcid.hpp"
+#include "PairKernels.hpp"
+
+using namespace std;
+
+// A candidate file is gzipped and starts with CANDIDATE_MAGIC and the
+// version.  After that come the records, each starting with its kind:
+// a structure (the PDB file and model the pairs after it are from),
+// a pair, and an end record so that a cut off file is noticed.  The
+// records are written a field at a time in little-endian order (see
+// CandidateFile.cpp), so a file written on one machine can be read on
+// another.  A file of any other version is not read
+#define CANDIDATE_MAGIC     "STAARCAN"
+#define CANDIDATE_VERSION   2
+
+#define CANDIDATE_ERROR    -1
+#define CANDIDATE_END       0
+#define CANDIDATE_STRUCTURE 1
+#define CANDIDATE_PAIR      2
+
+// Writes the candidate pairs of the search.  Only the atoms of the
+// conformers the closest centers came from are kept, along with what
+// was measured before the hydrogens
+class CandidateWriter
+{
+public:
+  // Constructor that leaves the file closed
+  CandidateWriter();
+
+  // Creates filename and writes the header.  Returns false if it can
+  // not be written
+  bool open(const char* filename);
+
+  // True between open and close
+  bool isOpen() const;
+
+  // Writes pair, found with threshold in PDBfile.  A structure record
+  // goes first if the last pair was from another file or model
+  void write(const PairCandidate& pair, float threshold, const PDB& PDBfile);
+
+  // Writes the end record and closes the file.  Returns false if
+  // anything could not be written
+  bool close();
+
+  unsigned int structures;      // Structure records written
+  unsigned int pairs;           //   and pair records
+
+private:
+  ogzstream    out;
+  bool         opened;
+  string       lastFile;        // Structure of the last pair written
+  int          lastModel;
+};
+
+// Reads a candidate file back one record at a time.  The pair read
+// points into the reader, which keeps the residues of all the pairs of
+// a structure until a pair of the next structure is read, so that they
+// can be held on to and finished together.  Its residues hold just the
+// atoms that were given, so given1 and given2 are all of them
+class CandidateReader
+{
+public:
+  // Constructor that leaves the file closed
+  CandidateReader();
+
+  // Opens filename and checks the header.  Returns false if it is not
+  // a candidate file this version can read
+  bool open(const char* filename);
+
+  // Reads the next record and returns its kind.  A file that ends
+  // before the end record or has a malformed one gives CANDIDATE_ERROR
+  int next();
+
+  unsigned int  version;        // Of the file opened, or 0 if it has none
+  string        filename;       // Of the last structure record
+  float         resolution;
+  int           model;
+
+  PairCandidate pair;           // Of the last pair record
+  float         threshold;
+
+private:
+  // Reads the atoms of one residue of a pair into atoms and makes r
+  // out of them
+  bool readResidue(vector<Atom>& atoms, AminoAcid& r);
+
+  igzstream            in;
+  deque< vector<Atom> > atoms;     // Of the pairs of this structure,
+  deque<AminoAcid>      residues;  //   which a deque does not move
+  bool                  fresh;     // True after a structure record
+};
+
+#endif
@@ -0,0 +1,143 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Distance.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Header file for the batched closest center search.  The squared
+//               distances are worked out with SSE or AVX2, picked at run time
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __DISTANCE_HPP__
+#define __DISTANCE_HPP__
+
+#include <vector>
+#include "AminoAcid.hpp"
+#include "Symmetry.hpp"
+#include "FixedPoint.hpp"
+
+using namespace std;
+
+// Queues up residue pairs and finds the closest pair of centers of each
+// one in a single pass.  The centers of every pair are laid out as one
+// combination per entry so the squared distances of the whole batch can
+// be worked out with packed instructions, and only the winner of each
+// pair gets a square root
+class DistanceBatch
+{
+public:
+  // Constructor that starts off empty
+  DistanceBatch();
+
+  // Queues the centers of a against those of b, with the combinations
+  // in the same order as findClosestDistance walks through them.
+  // Returns the index of the pair in the batch
+  unsigned int add(AminoAcid& a, AminoAcid& b);
+
+  // Same as above, but the centers of b are moved by op first
+  unsigned int add(AminoAcid& a, AminoAcid& b, const Transform& op);
+
+  // Finds the closest pair of centers under threshold for every queued
+  // pair.  The results go in closest, index1, and index2
+  void run(float threshold);
+
+  // Empties the batch
+  void clear();
+
+  // Number of pairs queued
+  unsigned int size() const;
+
+  vector<float>        closest; // Closest distance, FLT_MAX if none is under the threshold
+  vector<unsigned int> index1;  // Index of the closest center of a
+  vector<unsigned int> index2;  // Index of the closest center of b
+
+private:
+  // Fixed point version of run
+  void runFixed(float threshold);
+
+  // Pushes one combination of centers
+  void push(const Coordinates& a, const Coordinates& b, unsigned int i, unsigned int j);
+
+  vector<float>        ax, ay, az;  // Center of a for each combination
+  vector<float>        bx, by, bz;  // Center of b for each combination
+  vector<FixedCoordinates> fa, fb;  // The same in milli-Angstroms (fixed point only)
+  vector<unsigned int> ia, ib;      // Center indexes of each combination
+  vector<unsigned int> start;       // First combination of each pair
+  vector<float>        d2;          // Squared distances
+};
+
+// Builds the alternate location combinations of a that come closest to
+// the centers of b and the other way around, for the rings that have
+// too many to build up front.  Has to be called before the pair is
+// queued
+void addClosestCombinations(AminoAcid& a, AminoAcid& b, float threshold);
+
+// Same as above, but the centers of b are moved by op
+void addClosestCombinations(AminoAcid& a, AminoAcid& b, const Transform& op, float threshold);
+
+// Finds the closest pair of centers of aa1 and aa2 under threshold and
+// their indexes.  Returns FLT_MAX if there is none
+double findClosestDistance(AminoAcid& aa1,
+                           AminoAcid& aa2,
+                           float threshold,
+                           unsigned int* closest_index1,
+                           unsigned int* closest_index2);
+
+// Same as above, but the centers of aa2 are moved by op first
+double findClosestDistance(AminoAcid& aa1,
+                           AminoAcid& aa2,
+                           const Transform& op,
+                           float threshold,
+                           unsigned int* closest_index1,
+                           unsigned int* closest_index2);
+
+// Name of the instruction set the kernel picked (avx2, sse, or scalar)
+const char* distanceKernelName();
+
+// Switches every DistanceBatch over to fixed point: the centers are
+// rounded to the nearest milli-Angstrom and tested against the threshold
+// with 64 bit integer squared distances.  The test is exact, and so the
+// same everywhere, for the rounded centers.  The centers themselves are
+// still worked out in float from the atoms, so it is not an exact test
+// of the unrounded centers
+void setFixedPointDistances(bool on);
+bool fixedPointDistances();
+
+// Rounding the centers can bring a pair up to this much closer than the
+// floats say, so the searches that narrow things down with floats before
+// the real test have to look this much further in fixed point
+#define FIXED_POINT_SLACK 0.002
+
+// How far apart two centers may look in floating point and still pass
+// the threshold in the current mode
+float distanceReach(float threshold);
+
+#endif
@@ -0,0 +1,88 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: FixedPoint.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definition for coordinates kept as whole milli-Angstroms
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __FIXEDPOINT_HPP__
+#define __FIXEDPOINT_HPP__
+
+#include <string>
+#include "Coordinates.hpp"
+
+using namespace std;
+
+// PDB coordinates are written with three decimals, so a thousandth of
+// an Angstrom holds them exactly
+#define FIXED_POINT_SCALE 1000
+
+// A point in whole milli-Angstroms.  Squared distances between two of
+// these are worked out in 64 bit integers, so they come out the same
+// no matter what the compiler or the instruction set does with floats
+class FixedCoordinates
+{
+public:
+  // Constructor that sets everything to 0
+  FixedCoordinates();
+
+  // Rounds a point to the nearest milli-Angstrom
+  FixedCoordinates(const Coordinates& point);
+
+  // The same point as floats
+  Coordinates toCoordinates() const;
+
+  // Squared distance to another point in milli-Angstroms squared
+  long long squaredDistance(const FixedCoordinates& point) const;
+
+  int x, y, z;
+};
+
+// Reads the width characters of line starting at start as a fixed point
+// number with at most three decimals and four whole digits (like
+// "%8.3f") into *value, in thousandths.  negative is set for a leading
+// minus sign so that -0.000 can be told apart from 0.000.  Returns false
+// if the field is anything else, in which case the caller has to fall
+// back to a real parser
+bool parseFixedPoint(const string& line,
+                     unsigned int start,
+                     unsigned int width,
+                     int* value,
+                     bool* negative);
+
+// Turns a value from parseFixedPoint into the float that the %8.3f text
+// would have been read as.  This only holds while the value is below
+// 2^24, which parseFixedPoint makes sure of
+float fixedPointToFloat(int value, bool negative);
+
+#endif
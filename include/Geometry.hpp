@@ -98,5 +98,18 @@ float calculateAngleBetweenPlanes( Coordinates& planeP,
 				   AminoAcid& aa2,
 				   int index2 );
 
+// The same three angles again, for planes that were worked out once
+// with the centers.  The normals are already unit length, so each of
+// these is only a dot product and an arccos
+float angleBetweenPlaneAndLine(const Plane& plane,
+                               Coordinates& point1,
+                               Coordinates& point2);
+
+void planeProjectCoordinate(const Plane& plane,
+                            Coordinates& point,
+                            Coordinates* result);
+
+float calculateAngleBetweenPlanes(const Plane& plane1,
+                                  const Plane& plane2);
 
 #endif
@@ -0,0 +1,143 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: HydrogenCache.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Keeps the hydrogens Babel added to every residue it protonated in a model,
+//               so that a residue taking part in several pairs is protonated once
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#ifndef __HYDROGENCACHE_HPP__
+#define __HYDROGENCACHE_HPP__
+
+#include <map>
+#include <vector>
+#include <string>
+#include "Atom.hpp"
+
+using namespace std;
+
+class BabelPool;
+
+// Who puts the hydrogens on the residues of a pair
+#define HYDROGENS_BABEL    0    // Babel's AddHydrogens
+#define HYDROGENS_NATIVE   1    // placeHydrogens (HydrogenPlacer.hpp)
+#define HYDROGENS_COMPARE  2    // Babel, checking placeHydrogens against it
+
+// How Babel is called
+#define PROTONATE_RESIDUE  0    // On each residue the first time a pair needs it
+#define PROTONATE_MODEL    1    // Once on every residue of the model (PDB::protonateModel)
+
+// What a residue is protonated from: its name and where each of the
+// atoms given to Babel is.  The same atoms in the same place always
+// get the same hydrogens, so a moved copy of a residue or one whose
+// atoms changed is a different key
+class ResidueKey
+{
+public:
+  // Makes the key of the atoms given of residue
+  ResidueKey(const string& residue, const vector<Atom*>& given);
+
+  bool operator<(const ResidueKey& rhs) const;
+
+  string        residue;        // Residue name
+  vector<float> coords;         // x, y and z of every atom given, in order
+};
+
+// The hydrogens added to a single residue
+class ProtonatedResidue
+{
+public:
+  vector<Atom> hydrogens;       // Named " H  ", with the residue fields of the atom they are on
+  vector<int>  bondedTo;        // Index into the atoms given of the one each hydrogen is on
+  bool         corrected;       // True if removeExcessHydrogens had to step in
+  bool         failed;          // True if the Babel worker crashed or hung on it
+};
+
+// The hydrogens of every residue protonated so far, by ResidueKey
+class HydrogenCache
+{
+public:
+  // Constructor that starts off empty
+  HydrogenCache();
+
+  // Returns the entry for key, or NULL if it was never protonated.
+  // Counts a hit or a miss
+  ProtonatedResidue* find(const ResidueKey& key);
+
+  // True if key has an entry.  Not counted as a lookup
+  bool contains(const ResidueKey& key) const;
+
+  // Returns a new, empty entry for key to put the hydrogens in
+  ProtonatedResidue& insert(const ResidueKey& key);
+
+  // Forgets the entry for key, if there is one
+  void erase(const ResidueKey& key);
+
+  // Forgets every residue and resets the counts
+  void clear();
+
+  // Adds the counts of other to these, for totals over several models
+  void tally(const HydrogenCache& other);
+
+  int          engine;          // Who places the hydrogens (one of the HYDROGENS_ defines)
+  BabelPool*   pool;            // Workers that run Babel, or NULL to run it in-process
+  unsigned int hits;            // Lookups that found their residue
+  unsigned int misses;          // Lookups that had to place the hydrogens
+  unsigned int avoided;         // Pairs left out as too far apart to need them
+  unsigned int preloaded;       // Residues put in by PDB::protonateAhead
+  unsigned int compared;        // Residues placed both ways with HYDROGENS_COMPARE,
+  unsigned int disagreed;       //   the ones further than HYDROGEN_TOLERANCE apart,
+  float        worst;           //   and the furthest apart a hydrogen was
+
+private:
+  map<ResidueKey, ProtonatedResidue> entries;
+};
+
+// Makes the record of a hydrogen at h bonded to parent, written the way
+// Babel writes them and taking the residue fields from parent
+Atom makeHydrogen(const Atom& parent, int serial, const Coordinates& h);
+
+// This checks the validity of the hydrogens for 
+// GLU and ASP residues.  Sometimes babel will add 4 hydrogens:
+// 2 to C and 1 to each O.  We can figure out why, but we came
+// up with this hackish fix.  We take the 2 that are connected
+// to the carbon, average them, and use that as the coordinates 
+// for the hydrogen that we are looking for.  We then throw all
+// of the other hydrogens away.  given are the atoms p was placed on
+bool removeExcessHydrogens(const string& residue,
+                           const vector<Atom*>& given,
+                           ProtonatedResidue& p);
+
+#endif
@@ -0,0 +1,75 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: HydrogenPlacer.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Places the hydrogens of the supported residues with idealised bond
+//               lengths and angles, without going through Babel
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#ifndef __HYDROGENPLACER_HPP__
+#define __HYDROGENPLACER_HPP__
+
+#include <string>
+#include <vector>
+#include "HydrogenCache.hpp"
+
+using namespace std;
+
+// Idealised geometry of the hydrogens placed
+#define CH_BOND_LENGTH     1.08 // Aromatic and formate C-H
+#define NH_BOND_LENGTH     1.01 // Indole N-H
+#define OH_BOND_LENGTH     0.96 // Phosphate O-H
+#define POH_ANGLE          109.5
+
+// Furthest a placed hydrogen may be from Babel's before the residue
+// counts as a disagreement in HYDROGENS_COMPARE.  This is a guess at
+// what idealised geometry can match; it has not been checked against
+// the output of a real OpenBabel build
+#define HYDROGEN_TOLERANCE 0.1
+
+// Places the hydrogens of residue on the atoms given to Babel (the
+// slots of its residue table entry) and puts them in p.  Every C or N
+// bonded to two others (ring atoms and the carboxylate carbon, which
+// becomes formate) gets one in the plane of its neighbours, pointing
+// away from both.  Every oxygen on a phosphorus but the closest one,
+// taken as P=O, gets one at POH_ANGLE, anti to that oxygen.  Returns
+// false if residue has no entry in the table
+bool placeHydrogens(const string& residue, const vector<Atom*>& given, ProtonatedResidue& p);
+
+// Largest distance between a hydrogen of a and the closest one of b.
+// Returns -1 if they do not have the same number of hydrogens
+float compareHydrogens(const ProtonatedResidue& a, const ProtonatedResidue& b);
+
+#endif
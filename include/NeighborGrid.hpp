@@ -0,0 +1,79 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: NeighborGrid.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definition for a uniform cell grid used to find the points
+//               that lie close to a query point without testing every pair
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __NEIGHBORGRID_HPP__
+#define __NEIGHBORGRID_HPP__
+
+#include <vector>
+#include "Coordinates.hpp"
+
+// Upper bound on the number of cells so that a few atoms far away from
+// the rest of the structure do not make us allocate a huge empty grid
+#define MAX_GRID_CELLS 2097152
+
+class NeighborGrid
+{
+public:
+  // Constructor that leaves the grid empty
+  NeighborGrid();
+
+  // Buckets the points into cubic cells with an edge of cellSize
+  void build(const vector<Coordinates>& points, float cellSize);
+
+  // Appends to found the index of every point stored in a cell that a
+  // sphere of the given radius around p touches.  These are only
+  // candidates: the caller still has to check the actual distance
+  void query(const Coordinates& p, float radius, vector<unsigned int>& found) const;
+
+  // True if no points were given to build()
+  bool empty() const;
+
+  Coordinates lower;            // Lower corner of the box holding every point
+  Coordinates upper;            // Upper corner of the box holding every point
+
+private:
+  // Flattens cell indices into an offset in cellStart
+  int cellIndex(int i, int j, int k) const;
+
+  float cell;                   // Edge length of a cell
+  int   dims[3];                // Number of cells along x, y, and z
+  vector<unsigned int> cellStart; // Offset into cellItems of each cell (one extra at the end)
+  vector<unsigned int> cellItems; // Point indices ordered by cell
+};
+
+#endif
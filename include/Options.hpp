@@ -73,6 +73,30 @@ public:
   string extension;             // extension to use to append to pdb list files
   float resolution;             // Max resolution cut-off
   char* chain_list;             // like pdblist, but contains chains to search in
+  bool crystalContacts;         // Also look between the asymmetric unit and its
+                                // crystal symmetry mates
+  int assembly;                 // REMARK 350 biomolecule to build the interfaces
+                                // of (0 means no assembly)
+  char* queryfile;              // File of searches to run in a single pass
+  float verletSkin;             // Skin of the Verlet list kept across the models
+                                // of an ensemble (0 means no list)
+  bool fixedPoint;              // Compare the centers rounded to whole milli-Angstroms
+  int conformer;                // Which alternate locations are read in
+                                // (one of the CONFORMER_ defines in Atom.hpp)
+  int order;                    // Order the residues are searched in (experimental)
+                                // (one of the ORDER_ defines in SpaceCurve.hpp)
+  int hydrogens;                // Who adds the hydrogens
+                                // (one of the HYDROGENS_ defines in HydrogenCache.hpp)
+  int protonate;                // How Babel is called
+                                // (one of the PROTONATE_ defines in HydrogenCache.hpp)
+  unsigned int workers;         // Babel worker processes (0 runs Babel in-process)
+  unsigned int workerTimeout;   // Seconds a worker gets for a batch (0 means no limit)
+  char* candidatesOut;          // File the search writes its pairs to instead of finishing them
+  char* candidatesIn;           // File of pairs to finish instead of searching
+  unsigned int shard;           // Every shards-th model of candidatesIn is done,
+  unsigned int shards;          //   starting with model shard
+  float minEstimate;            // Binding (kcal/mol) the classical estimate must give
+                                //  a pair for it to get a GAMESS input file
 
   // Constructor that sets everything to empty stuff
   Options();  
@@ -83,6 +107,11 @@ public:
 
   // Parse the command line options
   void parseCmdline(int argc, char **argv);
+  // Sets residue1 and residue2 from a string like "PHE;GLU,ASP".
+  // Returns false if it is malformed
+  bool setResidues(const string& residues);
+  // Sets the ligands from a comma separated list
+  void setLigands(const string& ligandList);
   // Return true of cmd line parsing failed, false otherwise
   bool fail();
 
@@ -40,15 +40,14 @@
 #include <vector>
 #include <algorithm>
 #include <sys/stat.h>
-#ifndef NO_BABEL
-#include <openbabel/obconversion.h>
-#include <openbabel/mol.h>
-#endif
 #include "AminoAcid.hpp"
 #include "Atom.hpp"
 #include "Seqres.hpp"
 #include "Utils.hpp"
 #include "Chain.hpp"
+#include "Symmetry.hpp"
+#include "SpaceCurve.hpp"
+#include "HydrogenCache.hpp"
 
 
 static char INPheader[] = \
@@ -77,6 +76,21 @@ static char INPheader[] = \
 #define NO_RESOLUTION               -7
 #define MODEL_TO_NUMBER_FAILED      -8
 #define MULTIPLE_MODELS_SKIP        -9
+// Where a residue is in the chains, and its key along the curve the
+// residues are searched in
+class ResidueSlot
+{
+public:
+  unsigned int chain;           // Index into PDB::chains
+  unsigned int index;           // Index into Chain::aa
+  unsigned int key;             // Key along the curve
+
+  bool operator<(const ResidueSlot& rhs) const
+  {
+    return key < rhs.key;
+  }
+};
+
 class PDB
 {
 
@@ -118,18 +132,58 @@ public:
   void parsePDB(istream& file, float resolution);
 
 #ifndef NO_BABEL
-  // Calls Babel to add the hydrogens and inputs them into the PDB
-  void addHydrogensToPair(AminoAcid& a, AminoAcid& b, int cd1, int cd2);
+  // Calls Babel to add the hydrogens and puts the pair into the PDB.
+  // givenA and givenB are the atoms of a and b to protonate.  Each
+  // residue is protonated on its own and kept in cache, so Babel only
+  // sees the ones that are not in there yet.  The atoms and hydrogens
+  // are copied in as they are; nothing is written out or read back in.
+  // Returns false if Babel could not protonate one of the two
+  bool addHydrogensToPair(AminoAcid& a,
+                          AminoAcid& b,
+                          const vector<Atom*>& givenA,
+                          const vector<Atom*>& givenB,
+                          HydrogenCache& cache);
+
+  // Returns the hydrogens of r on the atoms given, from cache if they
+  // are in there.  cache.engine says whether Babel or placeHydrogens
+  // puts them there
+  ProtonatedResidue& protonateResidue(AminoAcid& r,
+                                      const vector<Atom*>& given,
+                                      HydrogenCache& cache);
+
+  // Protonates every conformer of every residue and ligand that is
+  // looked for in a single Babel call and puts them all in cache.
+  // Each residue is a molecule fragment of its own with the same bonds
+  // it gets when it is protonated alone (see bondFragment in
+  // BabelPool.cpp), so the molecules only differ in having the other
+  // fragments beside it.  Whether real Babel then places exactly the
+  // same hydrogens has not been checked yet; compareProtonation.sh in
+  // the scripts folder does that.  Pairs that need a residue that is
+  // not in there, like a moved copy, still protonate it on its own
+  void protonateModel(HydrogenCache& cache);
+
+  // Protonates the atoms given[i] of residues[i] that are not in cache
+  // yet in a single call, split over the workers of cache.pool, so that
+  // the pairs they were taken from find them there.  Pairs handed to
+  // Babel one at a time would each be a batch of one or two residues
+  // and keep the first worker busy while the others wait
+  void protonateAhead(const vector<AminoAcid*>& residues,
+                      const vector< vector<Atom*> >& given,
+                      HydrogenCache& cache);
 #endif
 
-  // Organizes the data read from parsePDB into chains
-  void populateChains(bool center);
+  // Organizes the data read from parsePDB into chains.  With lazy
+  // set, the centers of the residues are not calculated here but
+  // only once AminoAcid::ensureCenter is called
+  void populateChains(bool center, bool lazy=false);
 
   // Organizes ligands into an array
   void findLigands(vector<string> ligandsToFind);
   
+  // Puts the aromatic (named by aromatic) in r1 and the anion in r2
   void getPair(int& resSeq1, 
                int& resSeq2, 
+               const string& aromatic,
                Residue* r1, 
                Residue* r2, 
                bool ligand);
@@ -138,26 +192,37 @@ public:
                          vector<string>* r2);
 
   void setLigandsToFind(vector<string>* l);
+
+  // Sets how residues with alternate locations are read in (one of the
+  // CONFORMER_ defines)
+  void setConformer(int policy);
   // Puts the atoms in order by their sequence number
   void sortAtoms();
 
+  // Fills searchOrder with every residue of the chains, in the order
+  // given by curve (one of the ORDER_ defines in SpaceCurve.hpp).  The
+  // key of a residue comes from its first atom.  Only the order they are
+  // visited in changes; the residues and their atoms are not moved, so
+  // this does not make them any closer together in memory
+  void orderResidues(int curve);
+
   vector<string>* ligandsToFind;
   vector<string>* residue1;
   vector<string>* residue2;
+  int             conformer;      // CONFORMER_ALL keeps every alternate location
 
   vector<Chain>           chains;         // Variable to hold the chain information
   vector<Atom>            atoms;          // Vector hold all the atom lines
   vector<Atom>            hetatms;        // Vector holding all the hetatm lines
   vector<Residue*>        ligands;        // Vector holding all the ligand lines
+  vector<ResidueSlot>     searchOrder;    // Order the residues are searched in
+  HydrogenCache           hydrogens;      // Residues of this model protonated so far
   vector<Seqres>          seqres;         // Vector holding all the seqres lines
-  vector<string>          conect;         // Vector holding all the CONECT lines
+  UnitCell                cell;           // Unit cell from the CRYST1 line
+  vector<Transform>       symmetry;       // Crystal symmetry operators (REMARK 290 SMTRY)
+  vector<Biomolecule>     assemblies;     // Biological assemblies (REMARK 350)
 
   const char*             filename;       // Holds the filename, if needed
-#ifndef NO_BABEL
-  OpenBabel::OBConversion conv;           // Holds OpenBabel reading of important
-                                          //  residue pairs adding H. Will also 
-                                          //  be used to output to GAMESS format
-#endif
   int failflag;
   float resolution;
 
@@ -0,0 +1,206 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: PairKernels.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Pair evaluation compiled for every kind of aromatic and anion,
+//               and the table that picks one for a pair of residue names
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#ifndef __PAIRKERNELS_HPP__
+#define __PAIRKERNELS_HPP__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "AminoAcid.hpp"
+#include "Angles.hpp"
+#include "PDB.hpp"
+
+using namespace std;
+
+// Rounding allowed for when deciding from the bound on the centers of
+// charge that a pair cannot get within threshold
+#define CENTER_BOUND_SLACK 1e-3
+
+// The classical estimate of a pair's interaction: the anion as a point
+// charge in the field of the ring's quadrupole moment, and the dipole
+// the charge induces in the ring
+#define QUADRUPOLE_BENZENE    -6.47     // Theta_zz of benzene in atomic units (-8.7 D A)
+#define POLARIZABILITY_BENZENE_NORMAL 6.7   // Alpha of benzene along its normal,
+#define POLARIZABILITY_BENZENE_PLANE 12.3   //  and in its plane (cubic Angstroms)
+#define ESTIMATE_ANION_CHARGE -1        // Charge of the pair in the GAMESS input (ICHARG)
+#define BOHR_PER_ANGSTROM     1.889726
+#define KCAL_PER_HARTREE      627.5095
+
+// Pairs a PairQueue holds on to at most before it flushes them
+#define PAIR_QUEUE_LIMIT 1024
+
+class CandidateWriter;
+class PairQueue;
+
+// What a kernel needs besides the pair itself.  contact is the code
+// written instead of I/X when the anion is a moved copy: C for a
+// crystal symmetry mate and B for another chain copy of the biological
+// assembly
+class PairContext
+{
+public:
+  PairContext(float threshold, PDB& PDBfile, char* gamessfolder, ofstream& output, char contact=0);
+
+  float            threshold;
+  PDB&             PDBfile;
+  char*            gamessfolder;
+  ofstream&        output;
+  char             contact;
+  CandidateWriter* candidates;  // Where the pairs go instead of being finished, or NULL
+  PairQueue*       queue;       // Where the pairs wait to be measured and finished
+                                //  (or handed to candidates), or NULL
+  float            minEstimate; // Pairs not bound by at least this much (kcal/mol)
+                                //  by their estimate get no GAMESS input file
+};
+
+// A pair whose closest centers are within threshold and that the
+// hydrogens can still leave within it, with what was measured before
+// they are added.  given1 and given2 are the atoms of aa1 and aa2 the
+// closest centers were made from, which are what gets the hydrogens
+class PairCandidate
+{
+public:
+  AminoAcid*    aa1;
+  AminoAcid*    aa2;
+  vector<Atom*> given1;
+  vector<Atom*> given2;
+  char        code1;            // I/X (or the contact code) and S/M
+  char        code2;
+  float       closestDist;
+  float       angle;
+  float       angle1;
+  float       angleP;
+  Coordinates center1;          // The closest centers
+  Coordinates center2;
+};
+
+// Finds the best interaction of an aromatic (aa1) and an anion (aa2)
+// and finishes it, or hands it to ctx.candidates or ctx.queue if one
+// of them is set
+typedef void (*PairKernel)(AminoAcid& aa1, AminoAcid& aa2, PairContext& ctx);
+
+// Adds the hydrogens to a candidate, measures it again, and writes out
+// the results
+typedef void (*PairFinisher)(PairCandidate& pair, PairContext& ctx);
+
+// Returns the finisher for the pair of residue names, or NULL if there
+// is none
+PairFinisher findPairFinisher(const string& residue1, const string& residue2);
+
+// Pairs held back so that the work on them is done in batches: their
+// angles before the hydrogens go through one AngleBatch, and with Babel
+// workers the residues they need are protonated over all of them at
+// once (PDB::protonateAhead), and not a pair at a time on the first
+// one.  The residues of a pair held, and the PDB, output, and candidate
+// file of its context, must stay where they are until it is flushed
+class PairQueue
+{
+public:
+  // Holds on to pair to be finished with finish in ctx, or handed to
+  // ctx.candidates if that is set.  Its angles are measured at the
+  // flush, between center index1 of aa1 and center index2 of aa2.
+  // Flushes once PAIR_QUEUE_LIMIT pairs are held
+  void add(const PairCandidate& pair, int index1, int index2, PairFinisher finish, const PairContext& ctx);
+
+  // Same as above, for a pair whose angles were already measured
+  void add(const PairCandidate& pair, PairFinisher finish, const PairContext& ctx);
+
+  // Measures and protonates what the pairs held need and finishes them
+  // in the order they were added, so the results, GAMESS files, and
+  // candidate files come out as if they had been finished right away
+  void flush();
+
+private:
+  // A pair and the context it was added in, which is only held by
+  // reference in PairContext
+  class HeldPair
+  {
+  public:
+    PairCandidate    pair;
+    int              angles;    // Index of the pair in angles, or -1
+    PairFinisher     finish;
+    float            threshold;
+    PDB*             PDBfile;
+    char*            gamessfolder;
+    ofstream*        output;
+    char             contact;
+    CandidateWriter* candidates;
+    float            minEstimate;
+  };
+
+  // Holds on to pair with its context and returns it
+  HeldPair& hold(const PairCandidate& pair, PairFinisher finish, const PairContext& ctx);
+
+  vector<HeldPair> held;
+  AngleBatch       angles;      // Of the pairs held that were not measured yet
+};
+
+// Kernels for the pairs of residue names that are searched for, made
+// once when the program starts
+class PairKernelTable
+{
+public:
+  // Adds a kernel for every aromatic of residue1 with every anion of
+  // residue2 and ligands.  Pairings without one get a warning
+  void build(const vector<string>& residue1,
+             const vector<string>& residue2,
+             const vector<string>& ligands);
+
+  // Returns the kernel for the pair, or NULL if there is none
+  PairKernel find(const string& residue1, const string& residue2) const;
+
+private:
+  vector<string>     names1, names2;
+  vector<PairKernel> kernels;
+};
+
+// Number of pairs that got no GAMESS input file because of minEstimate
+unsigned int gamessHeldBack();
+
+// Writes the GAMESS input file.  With leaveOneOut, the anion atom that
+// is flagged to skip is left out
+void outputINPfile(string input_filename,
+                   char* filename,
+                   AminoAcid& aa1h,
+                   AminoAcid& aa2h,
+                   bool leaveOneOut);
+
+#endif
@@ -0,0 +1,66 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Plane.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Header file for the Plane class, the plane through three atoms kept
+//               with each center so the angles don't have to work it out again
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __PLANE_HPP__
+#define __PLANE_HPP__
+
+#include "Coordinates.hpp"
+
+// A plane stored as a unit normal and an offset, so that
+// normal . x + offset = 0 for every point x on the plane
+class Plane
+{
+public:
+  // Constructor that leaves the plane unset
+  Plane();
+
+  // Sets the plane through three points.  The normal points the same
+  // way as the one from getPlaneEquation
+  void set(Coordinates& point1,
+           Coordinates& point2,
+           Coordinates& point3);
+
+  // Signed distance of a point from the plane
+  float distance(const Coordinates& point) const;
+
+  Coordinates normal;           // Unit normal
+  float       offset;           // Offset along the normal
+  bool        valid;            // False if unset or the points are on a line
+};
+
+#endif
@@ -0,0 +1,81 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Query.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Header file for the Query class, one of the searches run over the
+//               PDB files in a single pass
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __QUERY_HPP__
+#define __QUERY_HPP__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Options.hpp"
+
+using namespace std;
+
+// One search of a multi-query run.  Each query carries its own copy of
+// the options, where only the residues, ligands, threshold, and same
+// chain flag differ from the command line, and its own output file
+class Query
+{
+public:
+  // Constructor that starts from the command line options
+  Query(const Options& base);
+  // Closes the output file
+  ~Query();
+
+  // Parses a line of the query file. Returns false if it is malformed
+  bool parse(const string& line);
+
+  Options  opts;                // Options used for this search
+  string   outputfile;          // File that the results are written to
+  ofstream output;              // ...and the stream to it
+};
+
+// Reads the query file, one query per line.  Blank lines and lines
+// starting with # are skipped.  Returns false if the file can not be
+// read or a line is malformed
+bool readQueryFile(const char* filename,
+                   const Options& base,
+                   vector<Query*>& queries);
+
+// Sets the residues and ligands of opts to the union of those of the
+// queries and the threshold to the largest one, so that a structure
+// can be read once for all of them
+void mergeQueries(vector<Query*>& queries, Options& opts);
+
+#endif
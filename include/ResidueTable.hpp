@@ -0,0 +1,119 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: ResidueTable.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Tables describing the atoms that the centers of every supported
+//               residue and ligand are made of
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#ifndef __RESIDUETABLE_HPP__
+#define __RESIDUETABLE_HPP__
+
+#include <string>
+
+using namespace std;
+
+// Packs a 4 character atom name (as in columns 13-16 of an ATOM line)
+// into a single number so names can be compared in one go
+#define ATOM_CODE(a,b,c,d) ( ((unsigned int)(a) << 24) | ((unsigned int)(b) << 16) | \
+                             ((unsigned int)(c) <<  8) |  (unsigned int)(d) )
+
+#define HYDROGEN_CODE ATOM_CODE(' ','H',' ',' ')
+
+// Most atoms a center can be made of, names that can fill each of
+// them, and atoms one atom can be bonded to in the CONECT lines
+#define MAX_RESIDUE_SLOTS 9
+#define MAX_SLOT_NAMES    2
+#define MAX_BONDED        4
+
+// How the centers of a residue are made from its slots
+#define CENTER_CONFORMERS   0  // A weighted average for every conformer
+#define CENTER_COMBINATIONS 1  // A weighted average for every combination of
+                               // alternate locations (see AltLocCombinations)
+#define CENTER_ATOMS        2  // Every slot with a weight is a center of its
+                               // own, for every conformer
+
+// How the center of charge is made once the hydrogens are in
+#define CHARGE_NONE        0   // Not supported
+#define CHARGE_WEIGHTED    1   // Weighted average of the slots and the
+                               // hydrogens, divided by ResidueEntry::chargeDivisor
+#define CHARGE_CARBOXYLATE 2   // HYDROGEN_BOND_DISTANCE away from the carbon,
+                               // on the other side from the hydrogen
+
+// Everything that is needed to go from the atoms of a residue to its
+// centers.  Adding a residue only takes one of these (and an entry
+// naming it) in ResidueTable.cpp
+struct ResidueDescriptor
+{
+  int          centers;                               // CENTER_*
+  unsigned int slots;                                 // Number of atoms used
+  unsigned int name[MAX_RESIDUE_SLOTS][MAX_SLOT_NAMES]; // ATOM_CODEs that can fill each slot
+  float        weight[MAX_RESIDUE_SLOTS];             // Weight in the centers
+  unsigned int planeSlots;                            // Slots put in plane_info,
+  int          plane[MAX_RESIDUE_SLOTS];              //   in this order
+
+  int          charges;                               // CHARGE_*
+  float        chargeWeight[MAX_RESIDUE_SLOTS];       // Weight in the center of charge
+  float        hydrogenCharge;                        // Weight of every hydrogen
+  unsigned int chargePlaneSlots;                      // Slots put in plane_info of
+  int          chargePlane[3];                        //   the center of charge
+
+  // CONECT lines handed to Babel: a slot followed by the slots it is
+  // bonded to, ended by -1
+  unsigned int conectLines;
+  int          conect[MAX_RESIDUE_SLOTS][MAX_BONDED+2];
+};
+
+// A residue name and how it is described
+struct ResidueEntry
+{
+  const char*              name;          // As in columns 18-20
+  const ResidueDescriptor* descriptor;
+  float                    chargeDivisor; // Formal charge (or count) the
+                                          // center of charge is divided by
+};
+
+// Returns the entry for a residue name, or NULL if it is not supported
+const ResidueEntry* findResidueEntry(const string& residue);
+
+// Packs an atom name with ATOM_CODE
+unsigned int atomCode(const string& name);
+
+// Returns the slot of d that an atom name fills, or -1 if the atom is
+// not one the centers are made of.  This is a single probe of a
+// perfect hash table made for d when the program starts
+int findSlot(const ResidueDescriptor* d, unsigned int code);
+
+#endif
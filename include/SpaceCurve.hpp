@@ -0,0 +1,70 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: SpaceCurve.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Morton and Hilbert keys of points in space, used to visit the residues
+//               in an order that keeps neighbours close together (--order)
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#ifndef __SPACECURVE_HPP__
+#define __SPACECURVE_HPP__
+
+#include <vector>
+#include "Coordinates.hpp"
+
+using namespace std;
+
+// Orders the residues can be searched in
+#define ORDER_SEQUENCE  0       // Chain by chain, as they are in the file
+#define ORDER_MORTON    1       // Along the Z-order (Morton) curve
+#define ORDER_HILBERT   2       // Along the Hilbert curve
+
+// Bits of every axis that go into a key, so keys fit in 30 bits
+#define CURVE_BITS 10
+
+// Key of the cell (x, y, z) along the Morton curve.  Every coordinate
+// has to be below 1 << CURVE_BITS
+unsigned int mortonKey(unsigned int x, unsigned int y, unsigned int z);
+
+// Key of the cell (x, y, z) along the Hilbert curve.  Every coordinate
+// has to be below 1 << CURVE_BITS
+unsigned int hilbertKey(unsigned int x, unsigned int y, unsigned int z);
+
+// Fills keys with the key of every point along the curve (one of the
+// ORDER_ defines), after spreading the bounding box of the points over
+// 1 << CURVE_BITS cells per axis.  With ORDER_SEQUENCE every key is 0
+void curveKeys(const vector<Coordinates>& points, int curve, vector<unsigned int>& keys);
+
+#endif
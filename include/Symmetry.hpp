@@ -0,0 +1,152 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Symmetry.hpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Class definitions for rigid-body operators (SMTRY/BIOMT) and the
+//               crystallographic unit cell read from CRYST1
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#ifndef __SYMMETRY_HPP__
+#define __SYMMETRY_HPP__
+
+#include <vector>
+#include <string>
+#include "Coordinates.hpp"
+#include "AminoAcid.hpp"
+
+// Tolerance used when comparing two operators with each other
+#define TRANSFORM_TOLERANCE 1e-3
+
+// A rigid-body operator of the form x' = R x + t.  Both the
+// crystallographic symmetry operators (REMARK 290 SMTRY) and the
+// biological assembly operators (REMARK 350 BIOMT) are stored like
+// this, in orthogonal Angstrom coordinates
+class Transform
+{
+public:
+  // Sets the operator to the identity
+  Transform();
+
+  // Applies the operator to a point
+  Coordinates apply(const Coordinates& p) const;
+
+  // Returns the operator that undoes this one
+  Transform inverse() const;
+
+  // Composition: (a * b) applied to x is a(b(x))
+  Transform operator*(const Transform& rhs) const;
+
+  // True if this operator does nothing
+  bool isIdentity() const;
+
+  // True if the two operators are the same within TRANSFORM_TOLERANCE
+  bool equals(const Transform& rhs) const;
+
+  float r[3][3];                // Rotation part
+  float t[3];                   // Translation part
+  int   serial;                 // Operator number as written in the PDB file
+};
+
+// The unit cell given by the CRYST1 record
+class UnitCell
+{
+public:
+  // Constructor that marks the cell as missing
+  UnitCell();
+
+  // Parses a CRYST1 line. Returns false if it is malformed
+  bool parseCRYST1(const string& line);
+
+  // Converts between orthogonal and fractional coordinates
+  Coordinates toFractional(const Coordinates& p) const;
+  Coordinates toOrthogonal(const Coordinates& p) const;
+
+  // Returns the translation by na, nb, and nc unit cells
+  Transform latticeShift(int na, int nb, int nc) const;
+
+  // A sphere of radius r spans reach[i] fractional units along axis i
+  void fractionalReach(float r, float reach[3]) const;
+
+  bool   valid;                 // False until a usable CRYST1 has been read
+  float  a, b, c;               // Cell edges in Angstroms
+  float  alpha, beta, gamma;    // Cell angles in degrees
+  string spaceGroup;            // Hermann-Mauguin symbol
+  float  orth[3][3];            // fractional -> orthogonal
+  float  frac[3][3];            // orthogonal -> fractional
+};
+
+// Parses one row of a REMARK 290 SMTRY or REMARK 350 BIOMT record and
+// stores it in the operator with the matching serial number, appending
+// a new operator when the serial has not been seen yet.  tag is either
+// "SMTRY" or "BIOMT".  Returns false if the line is malformed
+bool parseOperatorRow(const string& line, const char* tag, vector<Transform>& ops);
+
+// One "APPLY THE FOLLOWING TO CHAINS" block of a REMARK 350 biomolecule
+class AssemblyGroup
+{
+public:
+  string            chains;     // Chain identifiers, one character each
+  vector<Transform> ops;        // BIOMT operators applied to those chains
+};
+
+// A biological assembly as given by REMARK 350
+class Biomolecule
+{
+public:
+  int                   number; // BIOMOLECULE number
+  vector<AssemblyGroup> groups;
+};
+
+// One copy of a deposited chain inside a biological assembly.  Only the
+// chain and the operator are kept; the coordinates are never duplicated
+class ChainInstance
+{
+public:
+  unsigned int chain;           // Index into PDB::chains
+  Transform    op;              // Operator placing this copy
+};
+
+// Parses a REMARK 350 line, adding to the list of biomolecules.  Lines
+// that carry no assembly information are ignored.  Returns false if the
+// line is malformed
+bool parseAssemblyLine(const string& line, vector<Biomolecule>& assemblies);
+
+// Makes a copy of residue r with every atom moved by op.  The copied
+// atoms are stored in storage (which must not be touched for as long as
+// image is used) and the centers of image are recalculated from them
+void makeImageResidue(Residue& r,
+                      const Transform& op,
+                      vector<Atom>& storage,
+                      Residue* image);
+
+#endif
@@ -0,0 +1,86 @@
+// Checks the polynomial arccosine the angle batches use (see Angles.cpp)
+// against the libm acos, over every float from -1 to 1, and times the
+// two over a batch of random cosines.  Build and run with checkAngles.sh
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "Angles.hpp"
+#include "Utils.hpp"
+
+using namespace std;
+
+#define CHUNK   (1 << 20)
+#define REPEATS 100
+
+static float fromBits(unsigned int bits)
+{
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+int main()
+{
+  vector<float> x(CHUNK), y(CHUNK);
+  double maxError = 0;
+  float  worst = 0;
+  unsigned long count = 0;
+
+  // Every float bit pattern from 0 up to 1, then the same with the sign set
+  const unsigned int one = 0x3f800000;
+  for(unsigned int sign=0; sign<2; sign++)
+    {
+      for(unsigned long start=0; start<=one; start+=CHUNK)
+        {
+          unsigned int n = 0;
+          for(unsigned long b=start; b<=one && n<CHUNK; b++, n++)
+            {
+              x[n] = fromBits(b | (sign << 31));
+            }
+          arccosBatch(&x[0], n, &y[0]);
+          for(unsigned int k=0; k<n; k++)
+            {
+              double e = fabs(y[k] - acos((double)x[k]));
+              if( e > maxError )
+                {
+                  maxError = e;
+                  worst = x[k];
+                }
+            }
+          count += n;
+        }
+    }
+  printf("kernel:     %s\n", angleKernelName());
+  printf("checked:    %lu floats in [-1, 1]\n", count);
+  printf("max error:  %.3g rad (%.3g degrees) at x = %.9g\n", maxError, maxError * 180 / M_PI, worst);
+
+  // Timing over random cosines
+  srand(1);
+  for(unsigned int k=0; k<CHUNK; k++)
+    {
+      x[k] = 2.0f * rand() / RAND_MAX - 1.0f;
+    }
+  double t = getTime();
+  for(unsigned int r=0; r<REPEATS; r++)
+    {
+      arccosBatch(&x[0], CHUNK, &y[0]);
+    }
+  double batch = getTime() - t;
+  float sum = 0;
+  t = getTime();
+  for(unsigned int r=0; r<REPEATS; r++)
+    {
+      for(unsigned int k=0; k<CHUNK; k++)
+        {
+          y[k] = acosf(x[k]);
+        }
+      sum += y[r];
+    }
+  double libm = getTime() - t;
+  printf("batch:      %.3f ns per value\n", batch * 1e9 / ((double)CHUNK * REPEATS));
+  printf("libm acosf: %.3f ns per value (%g)\n", libm * 1e9 / ((double)CHUNK * REPEATS), sum);
+  printf("speedup:    %.1fx\n", libm / batch);
+  return 0;
+}
@@ -0,0 +1,14 @@
+#!/bin/bash
+# Measures the error and speed of the polynomial arccosine that
+# Angles.cpp uses for the angle, angle1, and angleP columns
+# Usage: bash checkAngles.sh (from anywhere in the source tree)
+
+top=`dirname $0`/../..
+out=`mktemp -d`
+
+g++ -O2 -I$top/include -o $out/checkAngles \
+    `dirname $0`/checkAngles.cpp $top/src/Angles.cpp $top/src/Utils.cpp $top/src/CoutColors.cpp || exit 1
+$out/checkAngles
+status=$?
+rm -rf $out
+exit $status
@@ -0,0 +1,33 @@
+#!/bin/bash
+# Checks, against the OpenBabel STAAR is built with, that protonating a
+# whole model in one Babel call (--protonate model) gives the same GAMESS
+# input as protonating each residue on its own, and reports how far the
+# native hydrogens (--hydrogens compare) are from Babel's
+# Usage: bash compareProtonation.sh staar_binary pdb_file [residues]
+
+if [ $# -lt 2 ]
+then
+    echo "Usage: compareProtonation.sh staar_binary pdb_file [residues]"
+    exit 3;
+fi
+
+staar=$1;
+pdb=$2;
+residues=${3:-"PHE,TYR;ASP,GLU"};
+out=`mktemp -d`
+
+for mode in residue model
+do
+    mkdir $out/$mode
+    $staar -p $pdb -r "$residues" -o $out/$mode.csv -g $out/$mode -P $mode > $out/$mode.log || exit 1
+done
+
+# The GAMESS inputs are numbered the same way in both modes
+total=`ls $out/residue | wc -l`
+differ=`diff -rq $out/residue $out/model | wc -l`
+echo "GAMESS inputs: "$total", differing between residue and model: "$differ
+diff -r $out/residue $out/model | head -20
+
+$staar -p $pdb -r "$residues" -o $out/compare.csv -H compare | grep "native hydrogens"
+
+rm -rf $out
@@ -0,0 +1,234 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: AltLocCombinations.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the AltLocCombinations class
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cmath>
+#include <cfloat>
+#include "AltLocCombinations.hpp"
+
+AltLocCombinations::AltLocCombinations()
+{
+  clear();
+}
+
+void AltLocCombinations::clear()
+{
+  slots.clear();
+  weights.clear();
+  planeSlots.clear();
+  divisor = 1;
+  lowerRest.assign(1, Coordinates(0,0,0));
+  upperRest.assign(1, Coordinates(0,0,0));
+}
+
+bool AltLocCombinations::empty() const
+{
+  return slots.empty();
+}
+
+void AltLocCombinations::addSlot(const vector<Atom*>& options, float weight)
+{
+  slots.push_back(options);
+  weights.push_back(weight);
+
+  // The boxes are sums from each slot to the end, so all of them move
+  unsigned int n = slots.size();
+  lowerRest.assign(n+1, Coordinates(0,0,0));
+  upperRest.assign(n+1, Coordinates(0,0,0));
+  for(int k=n-1; k>=0; k--)
+    {
+      Coordinates lo( FLT_MAX,  FLT_MAX,  FLT_MAX);
+      Coordinates hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+      for(unsigned int o=0; o<slots[k].size(); o++)
+        {
+          Coordinates w = slots[k][o]->coord * weights[k];
+          lo.set(fmin(lo.x, w.x), fmin(lo.y, w.y), fmin(lo.z, w.z));
+          hi.set(fmax(hi.x, w.x), fmax(hi.y, w.y), fmax(hi.z, w.z));
+        }
+      lowerRest[k] = lowerRest[k+1] + lo;
+      upperRest[k] = upperRest[k+1] + hi;
+    }
+}
+
+double AltLocCombinations::count() const
+{
+  double n = slots.empty() ? 0 : 1;
+  for(unsigned int k=0; k<slots.size(); k++)
+    {
+      n *= slots[k].size();
+    }
+  return n;
+}
+
+void AltLocCombinations::first(vector<unsigned int>& choice) const
+{
+  choice.assign(slots.size(), 0);
+}
+
+bool AltLocCombinations::next(vector<unsigned int>& choice) const
+{
+  for(int k=slots.size()-1; k>=0; k--)
+    {
+      if( ++choice[k] < slots[k].size() )
+        {
+          return true;
+        }
+      choice[k] = 0;
+    }
+  return false;
+}
+
+void AltLocCombinations::build(const vector<unsigned int>& choice, Coordinates* center) const
+{
+  Coordinates sum = slots[0][choice[0]]->coord * weights[0];
+  for(unsigned int k=1; k<slots.size(); k++)
+    {
+      sum += slots[k][choice[k]]->coord * weights[k];
+    }
+  *center = sum / divisor;
+  center->skip = false;
+
+  center->plane_info.resize(planeSlots.size());
+  for(unsigned int i=0; i<planeSlots.size(); i++)
+    {
+      center->plane_info[i] = &slots[planeSlots[i]][choice[planeSlots[i]]]->coord;
+    }
+  string t;
+  for(unsigned int k=0; k<slots.size(); k++)
+    {
+      t.insert(t.end(), 1, slots[k][choice[k]]->altLoc);
+    }
+  center->altLoc = t;
+}
+
+void AltLocCombinations::follow(char id, vector<unsigned int>& choice) const
+{
+  choice.assign(slots.size(), 0);
+  for(unsigned int k=0; k<slots.size(); k++)
+    {
+      bool exact = false;
+      for(unsigned int o=0; o<slots[k].size() && !exact; o++)
+        {
+          if( slots[k][o]->altLoc == id )
+            {
+              choice[k] = o;
+              exact = true;
+            }
+          else if( slots[k][o]->altLoc == ' ' )
+            {
+              choice[k] = o;
+            }
+        }
+    }
+}
+
+float AltLocCombinations::spread() const
+{
+  float s = 0;
+  for(unsigned int k=0; k<slots.size(); k++)
+    {
+      float widest = 0;
+      for(unsigned int a=0; a<slots[k].size(); a++)
+        {
+          for(unsigned int b=a+1; b<slots[k].size(); b++)
+            {
+              widest = fmax(widest, slots[k][a]->coord.distance(slots[k][b]->coord));
+            }
+        }
+      s += weights[k] * widest;
+    }
+  return s / divisor;
+}
+
+bool AltLocCombinations::closest(const Coordinates& target, float limit, vector<unsigned int>& choice) const
+{
+  if( slots.empty() )
+    {
+      return false;
+    }
+  vector<unsigned int> current(slots.size(), 0);
+  float best = limit;
+  bool found = false;
+  search(0, Coordinates(0,0,0), target, current, &best, choice, &found);
+  return found;
+}
+
+// The partial sums are added up in the same order as build() does it,
+// so the winner's center comes out exactly as it will be built
+void AltLocCombinations::search(unsigned int slot,
+                                const Coordinates& sum,
+                                const Coordinates& target,
+                                vector<unsigned int>& current,
+                                float* best,
+                                vector<unsigned int>& choice,
+                                bool* found) const
+{
+  if( slot == slots.size() )
+    {
+      Coordinates center = sum / divisor;
+      Coordinates t = target;
+      float d = center.distance(t);
+      if( d < *best )
+        {
+          *best  = d;
+          choice = current;
+          *found = true;
+        }
+      return;
+    }
+
+  for(unsigned int o=0; o<slots[slot].size(); o++)
+    {
+      Coordinates w = slots[slot][o]->coord * weights[slot];
+      Coordinates partial = slot == 0 ? w : sum + w;
+
+      // Closest the center can get to the target from here on
+      Coordinates lo = (partial + lowerRest[slot+1]) / divisor;
+      Coordinates hi = (partial + upperRest[slot+1]) / divisor;
+      float dx = fmax(0.0f, fmax(lo.x - target.x, target.x - hi.x));
+      float dy = fmax(0.0f, fmax(lo.y - target.y, target.y - hi.y));
+      float dz = fmax(0.0f, fmax(lo.z - target.z, target.z - hi.z));
+      float bound = sqrt(dx*dx + dy*dy + dz*dz);
+
+      // A little room for the rounding of the box
+      if( bound > *best * (1 + 1e-5) + 1e-5 )
+        {
+          continue;
+        }
+      current[slot] = o;
+      search(slot+1, partial, target, current, best, choice, found);
+    }
+}
@@ -36,8 +36,11 @@
 //  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*************************************************************************************************/
 
+#include <algorithm>
 #include "AminoAcid.hpp"
 #include "Geometry.hpp"
+#include "Angles.hpp"
+#include "ResidueTable.hpp"
 #include "CoutColors.hpp"
 
 AminoAcid::AminoAcid()
@@ -46,7 +49,11 @@ AminoAcid::AminoAcid()
   center.clear();
   skip = false;
   altLoc = false;
-  corrected = false;
+  centered = true;
+  representative = NULL;
+  pad = 0;
+  spread = 0;
+  built = 0;
 }
 
 AminoAcid::~AminoAcid()
@@ -55,7 +62,6 @@ AminoAcid::~AminoAcid()
   center.clear();
   skip = false;
   altLoc = false;
-  corrected = false;
 }
 
 // All combinations of centers are calculated for every possible
@@ -86,2310 +92,668 @@ AminoAcid::~AminoAcid()
 // examined later when we calculate the distances.
 //////////////////////////////////////////////////////////////////////
 
-// Calculate the centers for PHE or TYR
-// these AA need the following atoms:
-//   CG, CZ, CD1, CD2, CE1, CE2
-// all of the other ones don't affect the center
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerPHEorTYR()
+// Sorts the atoms into the slots of d.  Atoms that are not in any
+// slot are flagged so that they are left out of what goes to Babel.
+// Returns false, with a warning, if some slot has no atom at all
+bool AminoAcid::matchSlots(const ResidueDescriptor* d,
+                           vector< vector<Atom*> >& slots,
+                           bool flagUnused)
 {
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 6 atoms, the size of the outer vector
-  // is 6 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CG = 0 ; CZ = 1 ; CD1 = 2 ; CD2 = 3 ; CE1 = 4 ; CE2 = 5
-  vector< vector <Atom*> > temp;
-  temp.resize(6);
-
-  // Push all of the important atoms in their respective vectors
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ' )
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " CG ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CZ ")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CD1")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CD2")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CE1")
-        {
-          temp[4].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CE2")
-        {
-          temp[5].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-  
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0 ||
-     temp[4].size() == 0 || temp[5].size() == 0 )
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the PHE ring at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-
-  // Allocate size for all of the possible centers
-  center.resize(temp[0].size() * temp[1].size() * temp[2].size() *
-                temp[3].size() * temp[4].size() * temp[5].size());
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  for(unsigned int i = 0; i < temp[0].size(); i++) // go through all the CG
-    {
-      for(unsigned int j = 0; j < temp[1].size(); j++) // go through all the CZ
-        {
-          for(unsigned int k = 0; k < temp[2].size(); k++) // go through all the CD1
-            {
-              for(unsigned int l = 0; l < temp[3].size(); l++) // go through all the CD2
-                {
-                  for(unsigned int m = 0; m < temp[4].size(); m++) // go through all the CE1
-                    {
-                      for(unsigned int n = 0; n < temp[5].size(); n++, index++) // go through all the CE2
-                        {
-                          center[index].plane_info.resize(6);
-                          center[index].plane_info[ CG_PLANE_COORD_PTT] = &(temp[0][i]->coord);
-                          center[index].plane_info[CD1_PLANE_COORD_PTT] = &(temp[2][k]->coord);
-                          center[index].plane_info[CD2_PLANE_COORD_PTT] = &(temp[3][l]->coord);
-                          center[index].plane_info[3] = &(temp[1][i]->coord);
-                          center[index].plane_info[4] = &(temp[4][m]->coord);
-                          center[index].plane_info[5] = &(temp[5][n]->coord);
-
-                          // This is just an average of the all the coordinates
-                          center[index] = ( temp[0][i]->coord +
-                                            temp[1][j]->coord +
-                                            temp[2][k]->coord +
-                                            temp[3][l]->coord +
-                                            temp[4][m]->coord +
-                                            temp[5][n]->coord )/(6);
-
-                          // And this is just so we know what combination of
-                          // alternate locations (may be able to take out later)
-                          string t;
-                          t.insert(t.end(),1,temp[0][i]->altLoc);
-                          t.insert(t.end(),1,temp[1][j]->altLoc);
-                          t.insert(t.end(),1,temp[2][k]->altLoc);
-                          t.insert(t.end(),1,temp[3][l]->altLoc);
-                          t.insert(t.end(),1,temp[4][m]->altLoc);
-                          t.insert(t.end(),1,temp[5][n]->altLoc);
-                          center[index].altLoc = t;
-#ifdef DEBUG
-                          cout << "CHECK: " << residue << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-void AminoAcid::centerPHEorTYR_altloc()
-{
-  int numaltlocs = altlocs.size();
-  center.resize(numaltlocs);
-  if(numaltlocs > 1) this->altLoc = true;
-  for(unsigned int al = 0; al < numaltlocs; al++)
-    {
-      int C_count=0;
-      center[al].skip = false;
-      center[al].plane_info.resize(6);
-      center[al].set(0,0,0);
-      // Push all of the important atoms in their respective vectors
-      for(unsigned int i =0; i< altlocs[al].size(); i++)
-        {
-          if(altlocs[al][i]->name == " CG ")
-            {
-              center[al].plane_info[ CG_PLANE_COORD_PTT] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else if(altlocs[al][i]->name == " CZ ")
-            {
-              center[al].plane_info[3] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else if(altlocs[al][i]->name == " CD1")
-            {
-              center[al].plane_info[CD1_PLANE_COORD_PTT] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else if(altlocs[al][i]->name == " CD2")
-            {
-              center[al].plane_info[CD2_PLANE_COORD_PTT] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else if(altlocs[al][i]->name == " CE1")
-            {
-              center[al].plane_info[4] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else if(altlocs[al][i]->name == " CE2")
-            {
-              center[al].plane_info[5] = &(altlocs[al][i]->coord);
-              center[al] += altlocs[al][i]->coord;
-              C_count++;
-            }
-          else
-            {
-              // This means that this atom is not useful so we flag it 
-              altlocs[al][i]->skip = true;
-            }
-        }
-  
-      // Error check.  If we don't have at least one of each
-      // of the atoms, we throw a warning, set an ignore flag
-      // for future reference, and go to next altLoc
-      if(C_count != 6)
-        {
-          skip = true;
-#ifndef DISABLE_WARNING
-          cout << cyan << "WARNING" << reset << ": Could not find all atoms in the PHE ring at "
-               << altlocs[al][0]->resSeq << " altLoc: " << altlocs[al][0]->altLoc << endl;
-#endif
-        }
-      center[al] /= 6;
-    }
-}
-
-// Calculate the centers for TRP
-// these AA need the following atoms:
-//   CG, CH2, CD1, CD2, NE1, CE2, CE3, CZ2, CZ3
-// all of the other ones don't affect the center
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerTRP()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 9 atoms, the size of the outer vector
-  // is 9 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CG = 0  ; CH1 = 1 ; CD1 = 2 ; CD2 = 3 ; NE1 = 4 ; CE2 = 5 ;
-  // CE3 = 6 ; CZ2 = 7 ; CZ3 = 8
-  vector< vector <Atom*> > temp;
-  temp.resize(9);
-
-  // Push all of the important atoms in their respective vectors
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ' )
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " CG ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CH2")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CD1")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CD2")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " NE1")
-        {
-          temp[4].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CE2")
-        {
-          temp[5].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CE3")
-        {
-          temp[6].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CZ2")
-        {
-          temp[7].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CZ3")
-        {
-          temp[8].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0 ||
-     temp[4].size() == 0 || temp[5].size() == 0 ||
-     temp[6].size() == 0 || temp[7].size() == 0 ||
-     temp[8].size() == 0)
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the TRP ring at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-  // Allocate size for all of the possible centers
-  center.resize( temp[0].size() * temp[1].size() * temp[2].size() * temp[3].size()*
-                 temp[4].size() * temp[5].size() * temp[6].size() * temp[7].size() * temp[8].size());
-
-  // And go through all combinations of the alternate locations
-  // (Sorry that it is really freaking ugly)
-  unsigned int index = 0;
-  for(unsigned int i = 0; i < temp[0].size(); i++) // go through all the CG
-    {
-      for(unsigned int j = 0; j < temp[1].size(); j++) // go through all the CH2
-        {
-          for(unsigned int k = 0; k < temp[2].size(); k++) // go through all the CD1
-            {
-              for(unsigned int l = 0; l < temp[3].size(); l++) // go through all the CD2
-                {
-                  for(unsigned int m = 0; m < temp[4].size(); m++) // go through all the NE1
-                    {
-                      for(unsigned int n = 0; n < temp[5].size(); n++) // go through all the CE2
-                        {
-                          for(unsigned int o = 0; o < temp[6].size(); o++) // go through all the CE3
-                            {
-                              for(unsigned int p = 0; p < temp[7].size(); p++) // go through all the CZ2
-                                {
-                                  for(unsigned int q = 0; q < temp[8].size(); q++, index++) // go through all the CZ2
-                                    {
-                                      center[index].plane_info.resize(3);
-                                      center[index].plane_info[CG_PLANE_COORD_PTT]  = &temp[0][i]->coord;
-                                      center[index].plane_info[CD1_PLANE_COORD_PTT] = &temp[2][k]->coord;
-                                      center[index].plane_info[CD2_PLANE_COORD_PTT] = &temp[3][l]->coord;
-
-                                      // This is a weighted average of the atoms weighted
-                                      // by their mass
-                                      center[index] = ( temp[0][i]->coord * MASS_C +
-                                                        temp[1][j]->coord * MASS_C +
-                                                        temp[2][k]->coord * MASS_C +
-                                                        temp[3][l]->coord * MASS_C +
-                                                        temp[4][m]->coord * MASS_N +
-                                                        temp[5][n]->coord * MASS_C +
-                                                        temp[6][o]->coord * MASS_C +
-                                                        temp[7][p]->coord * MASS_C +
-                                                        temp[8][q]->coord * MASS_C )/(MASS_C*8+MASS_N);
-
-                                      // And this is just so we know what combination of
-                                      // alternate locations (may be able to take out later)
-                                      string t;
-                                      t.insert(t.end(),1,temp[0][i]->altLoc);
-                                      t.insert(t.end(),1,temp[1][j]->altLoc);
-                                      t.insert(t.end(),1,temp[2][k]->altLoc);
-                                      t.insert(t.end(),1,temp[3][l]->altLoc);
-                                      t.insert(t.end(),1,temp[4][m]->altLoc);
-                                      t.insert(t.end(),1,temp[5][n]->altLoc);
-                                      t.insert(t.end(),1,temp[6][o]->altLoc);
-                                      t.insert(t.end(),1,temp[7][p]->altLoc);
-                                      t.insert(t.end(),1,temp[8][q]->altLoc);
-                                      center[index].altLoc = t;
-#ifdef DEBUG
-                                      cout << "CHECK: TRP" << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-// DO NOT USE THIS!!!! If you use this, a fairy will lose its wings!
-// This is only here for legacy reasons because this is what the old
-// STAAR code used.  It is wrong.
-// Calculate the centers of charge for ASP
-// these AA need the following atoms:
-//   CG, CB, OD1, OD2
-// all of the other ones don't affect the center
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerASP()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 4 atoms, the size of the outer vector
-  // is 4 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CG = 0 ; CB = 1 ; OD1 = 2 ; OD2 = 3 ;
-  vector< vector <Atom*> > temp;
-  temp.resize(4);
-
-  // Push all of the important atoms in their respective vectors
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " CG ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " H  ")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OD1")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OD2")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0)
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the ASP side chain at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-
-  // Allocate size for all of the possible centers
-  center.resize(temp[0].size() * temp[1].size() * temp[2].size() * temp[3].size());
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  for(unsigned int i = 0; i < temp[0].size(); i++) // go through all the CG
-    {
-      for(unsigned int j = 0; j < temp[1].size(); j++) // go through all the CB
-        {
-          for(unsigned int k = 0; k < temp[2].size(); k++) // go through all the OD1
-            {
-              for(unsigned int l = 0; l < temp[3].size(); l++, index++) // go through all the OD2
-                {
-                  center[index].plane_info.resize(3);
-                  center[index].plane_info[C__PLANE_COORD_AG]  = &temp[0][i]->coord;
-                  center[index].plane_info[O_1_PLANE_COORD_AG] = &temp[2][k]->coord;
-                  center[index].plane_info[O_2_PLANE_COORD_AG] = &temp[3][l]->coord;
-
-                  // This is just an average of the all the coordinates
-                  center[index] = ( temp[0][i]->coord * CHARGE_C +
-                                    temp[1][j]->coord * CHARGE_H + // treating CB as H in formic acid
-                                    temp[2][k]->coord * CHARGE_O +
-                                    temp[3][l]->coord * CHARGE_O ) * -1;
-                  
-                  // And this is just so we know what combination of
-                  // alternate locations (may be able to take out later)
-                  string t;
-                  t.insert(t.end(),1,temp[0][i]->altLoc);
-                  t.insert(t.end(),1,temp[1][j]->altLoc);
-                  t.insert(t.end(),1,temp[2][k]->altLoc);
-                  t.insert(t.end(),1,temp[3][l]->altLoc);
-                  center[index].altLoc = t;
-#ifdef DEBUG
-                  cout << "CHECK: ASP" << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                }
-            }
-        }
-    }
-}
-
-// DO NOT USE THIS!!!! If you use this, puppies will be harmed!
-// This is only here for legacy reasons because this is what the old
-// STAAR code used.  It is wrong.  
-// Calculate the centers of charge for GLU
-// these AA need the following atoms:
-//   CG, CD, OE1, OE2
-// all of the other ones don't affect the center
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerGLU()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 4 atoms, the size of the outer vector
-  // is 4 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CG = 0 ; CD = 1 ; OE1 = 2 ; OE2 = 3
-  vector< vector <Atom*> > temp;
-  temp.resize(4);
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " H  ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " CD ")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OE1")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OE2")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0)
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the GLU side chain at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-
-  // Allocate size for all of the possible centers
-  center.resize(temp[0].size() * temp[1].size() * temp[2].size() * temp[3].size());
-
-    // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  for(unsigned int i = 0; i < temp[0].size(); i++) // go through all the CG
-    {
-      for(unsigned int j = 0; j < temp[1].size(); j++) // go through all the CD
-        {
-          for(unsigned int k = 0; k < temp[2].size(); k++) // go through all the OE1
-            {
-              for(unsigned int l = 0; l < temp[3].size(); l++, index++) // go through all the OE2
-                {
-
-                  center[index].plane_info.resize(3);
-                  center[index].plane_info[C__PLANE_COORD_AG]  = &(temp[1][j]->coord);
-                  center[index].plane_info[O_1_PLANE_COORD_AG] = &(temp[2][k]->coord);
-                  center[index].plane_info[O_2_PLANE_COORD_AG] = &(temp[3][l]->coord);
-                  
-                  // This is a weighted average weighted by the charges.
-                  // Since the charges sum to -1, we just need to negate the signs
-                  center[index] = ( temp[0][i]->coord * CHARGE_H + // CG treated as H in formic acid
-                                    temp[1][j]->coord * CHARGE_C +
-                                    temp[2][k]->coord * CHARGE_O +
-                                    temp[3][l]->coord * CHARGE_O ) * -1;
-                  
-                  // And this is just so we know what combination of
-                  // alternate locations (may be able to take out later)
-                  string t;
-                  t.insert(t.end(),1,temp[0][i]->altLoc);
-                  t.insert(t.end(),1,temp[1][j]->altLoc);
-                  t.insert(t.end(),1,temp[2][k]->altLoc);
-                  t.insert(t.end(),1,temp[3][l]->altLoc);
-                  center[index].altLoc = t;
-#ifdef DEBUG
-                  cout << "CHECK: GLU" << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                }
-            }
-        }
-    }
-}
-
-// Calculate the centers for ASP
-// these AA need the following atoms:
-//   OD1 and OD2
-// all of the other ones don't affect the center
-// This is is really simple: all it does is add the
-// OD1 and OD2 coords to the center vector.
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerASP_oxygen()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 3 atoms, the size of the outer vector
-  // is 3 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CG = 0 ; OD1 = 1 ; OD2 = 2
-  vector< vector <Atom*> > temp;
-  temp.resize(3);
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " CG ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OD1")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OD2")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if( temp[1].size() == 0 ||
-      temp[2].size() == 0)
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the ASP side chain at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-  unsigned int offset = temp[0].size() * temp[1].size() * temp[2].size();
-  // Allocate size for all of the possible centers
-  center.resize(offset * 2);
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  for(unsigned int k = 0; k < temp[1].size(); k++) // go through all the OD1
-    {      
-      for(unsigned int j = 0; j < temp[0].size(); j++) // go through all the CD
-        {
-          for(unsigned int l = 0; l < temp[2].size(); l++, index++) // go through all the OD2
-            {
-              
-              center[index].plane_info.resize(3);
-              center[index].plane_info[C__PLANE_COORD_AG]  = &(temp[0][j]->coord);
-              center[index].plane_info[O_1_PLANE_COORD_AG] = &(temp[1][k]->coord);
-              center[index].plane_info[O_2_PLANE_COORD_AG] = &(temp[2][l]->coord);
-              center[index + offset].plane_info.resize(3);
-              center[index + offset].plane_info[C__PLANE_COORD_AG]  = &(temp[0][j]->coord);
-              center[index + offset].plane_info[O_1_PLANE_COORD_AG] = &(temp[1][k]->coord);
-              center[index + offset].plane_info[O_2_PLANE_COORD_AG] = &(temp[2][l]->coord);
-                  
-              center[index] = temp[1][k]->coord;
-              center[index + offset] = temp[2][l]->coord;
-                  
-              // And this is just so we know what combination of
-              // alternate locations (may be able to take out later)
-              string t;
-              t.insert(t.end(),1,temp[0][j]->altLoc);
-              t.insert(t.end(),1,temp[1][k]->altLoc);
-              t.insert(t.end(),1,temp[2][l]->altLoc);
-              center[index].altLoc = t;
-              center[index + offset].altLoc = t;
-#ifdef DEBUG
-              cout << "CHECK: ASP" << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-            }
-        }
-    }
-}
-
-void AminoAcid::centerASP_oxygen_altloc()
-{
-
-  int numaltlocs = altlocs.size();
-  center.resize(numaltlocs*2);
-  if(numaltlocs > 1) this->altLoc = true;
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int al = 0; al < numaltlocs; al++)
-    {
-      int atom_count = 0;
-      center[al].skip = false;
-      center[al].plane_info.resize(3);
-      center[al].set(0,0,0);
-      center[al+numaltlocs].skip = false;
-      center[al+numaltlocs].plane_info.resize(3);
-      center[al+numaltlocs].set(0,0,0);
-      for(unsigned int i =0; i< altlocs[al].size(); i++)
-        {
-          if(altlocs[al][i]->name == " CG ")
-            {
-              center[al].plane_info[C__PLANE_COORD_AG]  = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[C__PLANE_COORD_AG]  = &(altlocs[al][i]->coord);
-              atom_count++;
-            }
-          else if(altlocs[al][i]->name == " OD1")
-            {
-              center[al].plane_info[O_1_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[O_1_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al] = altlocs[al][i]->coord;
-              atom_count++;
-            }
-          else if(altlocs[al][i]->name == " OD2")
-            {
-              center[al].plane_info[O_2_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[O_2_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs] = altlocs[al][i]->coord;
-              atom_count++;
-            }
-          else
-            {
-              // This means that this atom is not useful so we flag it 
-              altlocs[al][i]->skip = true;
-            }
-        }
-
-      // Error check.  If we don't have at least one of each
-      // of the atoms, we throw a warning, set an ignore flag
-      // for future reference, and leave the function
-      if(atom_count != 3)
-        {
-          skip = true;
-#ifndef DISABLE_WARNING
-          cout << cyan << "WARNING" << reset << ": Could not find all atoms in the ASP side chain at "
-               << atom[0]->resSeq << " altloc: " << altlocs[al][0]->altLoc << endl;
-#endif
-        }
-    }
-}
-
-// Calculate the centers for GLU
-// these AA need the following atoms:
-//   OE1 and OE2
-// all of the other ones don't affect the center
-// This is is really simple: all it does is add the
-// OE1 and OE2 coords to the center vector.
-// This also sets the plane coordinates used to calculate 
-// the angle later in the program
-void AminoAcid::centerGLU_oxygen()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 3 atoms, the size of the outer vector
-  // is 3 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // CD = 0 ; OE1 = 1 ; OE2 = 2
-  vector< vector <Atom*> > temp;
-  temp.resize(3);
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " CD ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OE1")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " OE2")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0)
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the GLU side chain at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-  unsigned int offset = temp[0].size() * temp[1].size() * temp[2].size();
-  // Allocate size for all of the possible centers
-  center.resize(offset * 2);
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  for(unsigned int k = 0; k < temp[1].size(); k++) // go through all the OE1
-    {
-      for(unsigned int j = 0; j < temp[0].size(); j++) // go through all the CD
-        {
-          for(unsigned int l = 0; l < temp[2].size(); l++, index++) // go through all the OE2
-            {
-              
-              center[index].plane_info.resize(3);
-              center[index].plane_info[C__PLANE_COORD_AG]  = &(temp[0][j]->coord);
-              center[index].plane_info[O_1_PLANE_COORD_AG] = &(temp[1][k]->coord);
-              center[index].plane_info[O_2_PLANE_COORD_AG] = &(temp[2][l]->coord);
-              center[index + offset].plane_info.resize(3);
-              center[index + offset].plane_info[C__PLANE_COORD_AG]  = &(temp[0][j]->coord);
-              center[index + offset].plane_info[O_1_PLANE_COORD_AG] = &(temp[1][k]->coord);
-              center[index + offset].plane_info[O_2_PLANE_COORD_AG] = &(temp[2][l]->coord);
-                  
-              center[index] = temp[1][k]->coord;
-              center[index + offset] = temp[2][l]->coord;
-                  
-              // And this is just so we know what combination of
-              // alternate locations (may be able to take out later)
-              string t;
-              t.insert(t.end(),1,temp[0][j]->altLoc);
-              t.insert(t.end(),1,temp[1][k]->altLoc);
-              t.insert(t.end(),1,temp[2][l]->altLoc);
-              center[index].altLoc = t;
-              center[index + offset].altLoc = t;
-#ifdef DEBUG
-              cout << "CHECK: GLU" << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-            }
-        }
-    }
-}
-
-void AminoAcid::centerGLU_oxygen_altloc()
-{
-
-  int numaltlocs = altlocs.size();
-  center.resize(numaltlocs*2);
-  if(numaltlocs > 1) this->altLoc = true;
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int al = 0; al < numaltlocs; al++)
-    {
-      int atom_count = 0;
-      center[al].skip = false;
-      center[al].plane_info.resize(3);
-      center[al].set(0,0,0);
-      center[al+numaltlocs].skip = false;
-      center[al+numaltlocs].plane_info.resize(3);
-      center[al+numaltlocs].set(0,0,0);
-      for(unsigned int i =0; i< altlocs[al].size(); i++)
-        {
-          if(altlocs[al][i]->name == " CD ")
-            {
-              center[al].plane_info[C__PLANE_COORD_AG]  = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[C__PLANE_COORD_AG]  = &(altlocs[al][i]->coord);
-              atom_count++;
-            }
-          else if(altlocs[al][i]->name == " OE1")
-            {
-              center[al].plane_info[O_1_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[O_1_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al] = altlocs[al][i]->coord;
-              atom_count++;
-            }
-          else if(altlocs[al][i]->name == " OE2")
-            {
-              center[al].plane_info[O_2_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs].plane_info[O_2_PLANE_COORD_AG] = &(altlocs[al][i]->coord);
-              center[al+numaltlocs] = altlocs[al][i]->coord;
-              atom_count++;
-            }
-          else
-            {
-              // This means that this atom is not useful so we flag it 
-              altlocs[al][i]->skip = true;
-            }
-        }
-
-      // Error check.  If we don't have at least one of each
-      // of the atoms, we throw a warning, set an ignore flag
-      // for future reference, and leave the function
-      if(atom_count != 3)
-        {
-          skip = true;
-#ifndef DISABLE_WARNING
-          cout << cyan << "WARNING" << reset << ": Could not find all atoms in the GLU side chain at "
-               << atom[0]->resSeq << " altloc: " << altlocs[al][0]->altLoc << endl;
-#endif
-        }
-    }
-}
-
-void AminoAcid::centerPHEorTYR_simplified()
-{
-  center.resize(1);
-
-  // Temp variable that will have the center coordinates
-  Coordinates tempCenter(0.0, 0.0, 0.0);
-
-  // Here, we are just getting 2 C atoms. Doesn't matter
-  // which ones we choose as long as they are
-  // diametrically opposed. Based off of 
-  // http://comp.chem.nottingham.ac.uk/dichrocalc/files/atomlabels-sidechains.png
-  // the following are diametically opposed:
-  //   CG  - CZ
-  //   CD2 - CE1
-  //   CD1 - CE2
-  center[0].set(0.0, 0.0, 0.0);
-  center[0].plane_info.resize(3);
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->name == " CE2")
-        {
-          center[0] += atom[i]->coord;
-          center[0].plane_info[CE2_PLANE_COORD_PTT] = &atom[i]->coord;
-        }
-      else if(atom[i]->name == " CD1")
-        {
-          center[0] += atom[i]->coord;
-          center[0].plane_info[CD1_PLANE_COORD_PTT] = &atom[i]->coord;
-        }
-      else if(atom[i]->name == " CG ")
-        {
-          center[0].plane_info[CG_PLANE_COORD_PTT] = &atom[i]->coord;
-        }
-    }
-  center[0] /= 2;
-}
-
-void AminoAcid::centerASP_charge()
-{
-  center.resize(1);
-  Coordinates tempCenter(0.0, 0.0, 0.0);
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->name == " CG ")
-        {
-          center[0] = atom[i]->coord;
-          tempCenter += atom[i]->coord;
-        }
-      else if(atom[i]->name == " H  ")
-        {
-          tempCenter -= atom[i]->coord;
-        }
-    }
-  center[0] += (tempCenter * HYDROGEN_BOND_DISTANCE) / tempCenter.norm();
-}
-
-void AminoAcid::centerGLU_charge()
-{
-  center.resize(1);
-  Coordinates tempCenter(0.0, 0.0, 0.0);
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->name == " CD ")
-        {
-          center[0] = atom[i]->coord;
-          tempCenter += atom[i]->coord;
-        }
-      else if(atom[i]->name == " H  ")
-        {
-          tempCenter -= atom[i]->coord;
-        }
-    }
-  center[0] += (tempCenter * HYDROGEN_BOND_DISTANCE) / tempCenter.norm();
-}
-
-
-// Calculate the centers for PO4, 2HP, PI
-// these AA need the following atoms:
-//   P, O1, O2, O3, and O4
-void AminoAcid::centerPO4or2HPorPI()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 5 atoms, the size of the outer vector
-  // is 5 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // P = 0 ; O1 = 1 ; O2 = 2 ; O3 = 3 ; O4 = 4
-  vector< vector <Atom*> > temp;
-  temp.resize(5);
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " P  ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O1 ")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O2 ")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O3 ")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O4 ")
-        {
-          temp[4].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0 ||
-     temp[4].size() == 0 )
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue <<  " at "
-           << atom[0]->resSeq << " chain " << atom[0]->chainID << endl;
-#endif
-      return;
-    }
-
-  // Allocate size for all of the possible centers
-  center.resize( temp[0].size() * temp[1].size() * temp[2].size() * temp[3].size() * temp[4].size() );
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  float totalmass = MASS_P + MASS_O * 4;
-  for(unsigned int j = 0; j < temp[0].size(); j++) // go through all the P
-    {
-      for(unsigned int k = 0; k < temp[1].size(); k++) // go through all the O1
-        {
-          for(unsigned int l = 0; l < temp[2].size(); l++) // go through all the O2
-            {
-              for(unsigned int m = 0; m < temp[3].size(); m++) // go through all the O3
-                {
-                  for(unsigned int n = 0; n < temp[4].size(); n++, index++) // go through all the O4
-                    {
-                      center[index] = temp[0][j]->coord * MASS_P +
-                        ( temp[1][k]->coord + temp[2][l]->coord +
-                          temp[3][m]->coord + temp[4][n]->coord ) * MASS_O;
-
-                      center[index] /= totalmass;
-
-                      center[index].plane_info.resize(5);
-                      center[index].plane_info[0] = &(temp[0][j]->coord);
-                      center[index].plane_info[1] = &(temp[1][k]->coord);
-                      center[index].plane_info[2] = &(temp[2][l]->coord);
-                      center[index].plane_info[3] = &(temp[3][m]->coord);
-                      center[index].plane_info[4] = &(temp[4][n]->coord);
-
-#ifdef DEBUG
-                      cout << "CHECK: " << residue  << " " << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                    }
-                }
-            }
-        }
-    }
-}
-
-void AminoAcid::centerPO4or2HPorPI_charge()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 6 atoms, the size of the outer vector
-  // is 3 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // P = 0 ; O1 = 1 ; O2 = 2 ; O3 = 3 ; O4 = 4
-  Atom* P = NULL;
-  vector< Atom* > O;
-  vector< Atom* > H;
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " P  ")
-        {
-          P = atom[i];
-        }
-      else if(atom[i]->name == " O1 ")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O2 ")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O3 ")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O4 ")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " H  ")
-        {
-          H.push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check to see if we have 1 P, 4 O, and at least 1 H
-  if(P == NULL || O.size() != 4 || H.size() == 0 )
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue <<  " at "
-           << atom[0]->resSeq << " chain " << atom[0]->chainID << endl;
-#endif
-      cout << cyan << "Skipping " << reset << " because there weren't enough hydrogens in " 
-           << residue << " " << atom[0]->resSeq << " chain " << atom[0]->chainID << endl;
-      return;
-    }
-
-  center.resize( 1 );
-  // Here is an estimate of the center by doing a charge weighted average
-  // This could be wrong, but it is just something to put in here for the
-  // time being until I talk with Dr. Hinde.
-  center[0] = P->coord * CHARGE_P;
-  Coordinates temp(0.0, 0.0, 0.0);
-  temp  = O[0]->coord;
-  temp += O[1]->coord;
-  temp += O[2]->coord;
-  temp += O[3]->coord;
-  center[0] += temp*CHARGE_O;
-  temp.set(0.0,0.0,0.0);
-  for(unsigned int i=0; i<H.size(); i++)
-    {
-      temp += H[i]->coord;
-    }
-  center[0] += temp * CHARGE_H;
-
-  // And since the formal charge of PO4 is -3, divide by it
-  if(residue == "PO4")
-    center[0] /= -3;
-  else if(residue == "2HP")
-    center[0] *= -1;
-  else if(residue == " PI")
-    {
-      center[0] /= -2;
-    }
-}
-
-// Calculate the centers for 2PO and PO3
-// these AA need the following atoms:
-//   P, O1(P), O2(P), O3(P)
-void AminoAcid::center2POorPO3()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 5 atoms, the size of the outer vector
-  // is 5 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // P = 0 ; O1(P) = 1 ; O2(P) = 2 ; O3(P) = 3 
-  vector< vector <Atom*> > temp;
-  temp.resize(4);
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " P  ")
-        {
-          temp[0].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O1 " || atom[i]->name == " O1P")
-        {
-          temp[1].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O2 " || atom[i]->name == " O2P")
-        {
-          temp[2].push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O3 " || atom[i]->name == " O3P")
-        {
-          temp[3].push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check.  If we don't have at least one of each
-  // of the atoms, we throw a warning, set an ignore flag
-  // for future reference, and leave the function
-  if(temp[0].size() == 0 || temp[1].size() == 0 ||
-     temp[2].size() == 0 || temp[3].size() == 0 )
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue <<  " at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-
-  // Allocate size for all of the possible centers
-  center.resize( temp[0].size() * temp[1].size() * temp[2].size() * temp[3].size() );
-
-  // And go through all combinations of the alternate locations
-  unsigned int index = 0;
-  float totalmass = MASS_P + MASS_O * 4;
-  for(unsigned int j = 0; j < temp[0].size(); j++) // go through all the P
-    {
-      for(unsigned int k = 0; k < temp[1].size(); k++) // go through all the O1
-        {
-          for(unsigned int l = 0; l < temp[2].size(); l++) // go through all the O2
-            {
-              for(unsigned int m = 0; m < temp[3].size(); m++) // go through all the O3
-                {
-                  center[index] = temp[0][j]->coord * MASS_P +
-                    ( temp[1][k]->coord + temp[2][l]->coord +
-                      temp[3][m]->coord  ) * MASS_O;
-
-                  center[index] /= totalmass;
-
-                  center[index].plane_info.resize(4);
-                  center[index].plane_info[0] = &(temp[0][j]->coord);
-                  center[index].plane_info[1] = &(temp[1][k]->coord);
-                  center[index].plane_info[2] = &(temp[2][l]->coord);
-                  center[index].plane_info[3] = &(temp[3][m]->coord);
-
-#ifdef DEBUG
-                  cout << "CHECK: " << residue  << " " << atom[0]->resSeq << " : " << center[index] << endl;
-#endif
-                }
-            }
-        }
-    }
-}
-
-void AminoAcid::center2POorPO3_charge()
-{
-  // This makes a vector of a vector of ATOM* 
-  // since we are looking for 6 atoms, the size of the outer vector
-  // is 3 while the size of the inner vectors are dependent on the 
-  // number of alternate locations for each one. Indexes are:
-  // P = 0 ; O1 = 1 ; O2 = 2 ; O3 = 3 ; O4 = 4
-  Atom* P = NULL;
-  vector< Atom* > O;
-  vector< Atom* > H;
-
-  // Push all of the important atoms in their respective vectors  
-  for(unsigned int i =0; i< atom.size(); i++)
-    {
-      if(atom[i]->altLoc != ' ')
-        {
-          altLoc = true;
-        }
-      if(atom[i]->name == " P  ")
-        {
-          P = atom[i];
-        }
-      else if(atom[i]->name == " O1 " || atom[i]->name == " O1P")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O2 " || atom[i]->name == " O2P")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " O3 " || atom[i]->name == " O3P")
-        {
-          O.push_back(atom[i]);
-        }
-      else if(atom[i]->name == " H  ")
-        {
-          H.push_back(atom[i]);
-        }
-      else
-        {
-          // This means that this atom is not useful so we flag it 
-          atom[i]->skip = true;
-        }
-    }
-
-  // Error check to see if we have 1 P, 4 O, and at least 1 H
-  if(P == NULL || O.size() != 3 || H.size() == 0 )
-    {
-      skip = true;
-#ifndef DISABLE_WARNING
-      cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue <<  " at "
-           << atom[0]->resSeq << endl;
-#endif
-      return;
-    }
-
-  center.resize( 1 );
-  // Here is an estimate of the center by doing a charge weighted average
-  // This could be wrong, but it is just something to put in here for the
-  // time being until I talk with Dr. Hinde.
-  center[0] = P->coord * CHARGE_P;
-  Coordinates temp(0.0, 0.0, 0.0);
-  temp  = O[0]->coord;
-  temp += O[1]->coord;
-  temp += O[2]->coord;
-  center[0] += temp*CHARGE_O;
-  temp.set(0.0,0.0,0.0);
-  for(unsigned int i=0; i<H.size(); i++)
-    {
-      temp += H[i]->coord;
-    }
-  center[0] += temp * CHARGE_H;
-
-  // And since the formal charge of PO4 is -3, divide by it
-  if(residue == "2PO")
-    center[0] /= -2;
-  else if(residue == "PO3")
-    center[0] /= -3;
-}
-
-template<class T>
-int find_index(vector<T>& vec, T to_find)
-{
-  for(int i=0; i<vec.size(); i++)
-    {
-      if(vec[i] == to_find) return i;
-    }
-  return vec.size();
-}
-
-void AminoAcid::determineAltLoc(vector<char>&altloc_ids)
-{
-  int count = altloc_ids.size();
-  if(count == 0)
-    {
-      count = 1;
-      altlocs.resize(1);
-      for(int i=0; i<this->atom.size(); i++)
-        {
-          this->atom[i]->skip = false;
-          altlocs[0].push_back(this->atom[i]);
-        }
-    }
-  else
-    {
-      altlocs.resize(count);
-
-      for(int i=0; i<this->atom.size(); i++)
-        {
-          if(this->atom[i]->altLoc == ' ')
-            {
-              for(int j=0; j<count; j++)
-                {
-                  this->atom[i]->skip = false;
-                  altlocs[j].push_back(this->atom[i]);
-                }
-            }
-          else
-            {
-              this->atom[i]->skip = false;
-              int idx = find_index(altloc_ids, this->atom[i]->altLoc);
-              altlocs[idx].push_back(this->atom[i]);
-            }
-        }
-    }
-
-  // for(int j=0; j<count; j++)
-  //   {
-  //     for(int i=0; i<altlocs[j].size(); i++)
-  //       cout << *altlocs[j][i] << endl;
-  //   }
-
-}
-
-// Calculates the center of the amino acid
-void AminoAcid::calculateCenter(bool centerOfCharge)
-{
-  if( !centerOfCharge )
-    {
-      // TRP
-      if ( residue == "TRP" )
-        {
-          centerTRP();
-        }
-      // PHE or TYR
-      else if ( residue == "PHE" || residue == "TYR" )
-        {
-          centerPHEorTYR_altloc();
-        }
-      // ASP
-      else if (residue == "ASP")
-        {
-          centerASP_oxygen_altloc();
-        }
-      // GLU
-      else if (residue == "GLU")
-        {
-          centerGLU_oxygen_altloc();
-        }
-      else if (residue == "PO4" || residue == "2HP" || residue == " PI")
-        {
-          centerPO4or2HPorPI();
-        }
-      else if (residue == "2PO" || residue == "PO3")
-        {
-          center2POorPO3();
-        }
-      // This is for all of other amino acids out there that we 
-      // don't support
-      else
-        {
-          //cerr << red << "ERROR" << reset << ": " << residue << " is not yet supported." << endl;
-          skip = true;
-        }
-    }
-  // Now we are going to calculate the center of charges for the formate
-  else
-    {
-      // PHE or TYR
-      if ( residue == "PHE" || residue == "TYR" )
-        {
-          // So, this does a simplified center of mass calculation that
-          // Dr. Hinde used.  See function notes above for details.
-          centerPHEorTYR_simplified();
-        }
-      // ASP
-      else if (residue == "ASP")
-        {
-          centerASP_charge();
-        }
-       // GLU
-      else if (residue == "GLU")
-        {
-          centerGLU_charge();
-        }
-      else if (residue == "PO4" || residue == "2HP" || residue == " PI")
-        {
-          centerPO4or2HPorPI_charge();
-        }
-      else if (residue == "2PO" || residue == "PO3")
-        {
-          center2POorPO3();
-        }
-    }
-}
-
-void AminoAcid::calculateAnglesPreHydrogens(AminoAcid aa2,
-                                            int index1,
-                                            int index2,
-                                            float* angle,
-                                            float* angle1,
-                                            float* angleP)
-{
-  AminoAcid aa1 = *this;
-  Coordinates planeP;
-  Coordinates planeProject;
-
-  // Calculate the equation of the plane
-  float det = getPlaneEquation( *(aa1.center[index1].plane_info[ CG_PLANE_COORD_PTT]),
-                                *(aa1.center[index1].plane_info[CD1_PLANE_COORD_PTT]),
-                                *(aa1.center[index1].plane_info[C_2_PLANE_COORD_PTT]),
-                                &planeP);
-
-  // Calculate the angle between a plane and a line
-  *angle = angleBetweenPlaneAndLine( planeP,
-                                     aa1.center[index1],
-                                     aa2.center[index2]);
-  
-  // Calculate the "plane project" coordinates
-  planeProjectCoordinate( planeP, 
-                          aa2.center[index2],
-                          -1 * det, 
-                          &planeProject);
-  
-  // find the second angle betwen the CG ATOM and the "plane project"
-  *angle1 = findAngle(*aa1.center[index1].plane_info[ CG_PLANE_COORD_PTT],
-                      aa1.center[index1],
-                      planeProject);
-  
-  // finally, calculate the angle between the planes of AA1 and AA2
-  *angleP = calculateAngleBetweenPlanes( planeP,
-                                         aa2,
-                                         index2 );
-
-}
-
-bool AminoAcid::calculateDistancesAndAnglesPostHydrogens(AminoAcid aa2,
-                                                         Coordinates closestOxygen,
-                                                         float threshold,
-                                                         float* dist,
-                                                         float* distOxy,
-                                                         float* distOxy2,
-                                                         float* angle,
-                                                         float* angleOxy,
-                                                         float* angleOxy2)
-{
-  AminoAcid aa1 = *this;
-
-  // These are the 3 points in the benzene ring determined in centerPHEorTYR_simplified()
-  Coordinates dBenzene1 = *aa1.center[0].plane_info[1] - *aa1.center[0].plane_info[0];
-  Coordinates dBenzene2 = *aa1.center[0].plane_info[2] - *aa1.center[0].plane_info[0];
-
-  // These values are just to match the Perl script
-  float a = dBenzene1.x;
-  float b = dBenzene1.y;
-  float c = dBenzene1.z;
-  float d = dBenzene2.x;
-  float e = dBenzene2.y;
-  float f = dBenzene2.z;
-
-  // Get the perpendicular vector
-  float xp = b * f - c * e;
-  float yp = c * d - a * f;
-  float zp = a * e - b * d;
-  Coordinates perp(xp, yp, zp);  
-
-  // Calculate the distance between the centers
-  // This is the vector pointing from the benzene center to formate center of charge
-  Coordinates distance = aa2.center[0] - aa1.center[0];
-
-  
-  float num = dotProduct(perp, distance);
-  float perpnorm = perp.norm();
-  float distFromMassToChg = distance.norm();
-  float denom = perpnorm * distFromMassToChg;
-
-  if(distFromMassToChg > threshold)
-    {
-      cout << gray << "Note" << reset << ": post hydrogen distance, " << distFromMassToChg <<" > "<< threshold << "A.  Skipping." << endl;
-      return false;
-    }
-
-  if(denom == 0)
-    {
-      cerr << red << "Error" << reset << ": denom is zero.  Skipping residue" << endl;
-      return false;
-    }  
-
-  // We already have one of the oxygens as an input param
-  // Now let's find the other one
-  Coordinates otherOxygen;
-  for(int i = 0; i < aa2.atom.size(); i++)
-    {
-      // Only look at the oxygen atoms
-      if(aa2.atom[i]->element == "O")
-        {
-          // Make sure this oxygen is different than the closest one
-          if(aa2.atom[i]->coord.x != closestOxygen.x ||
-             aa2.atom[i]->coord.y != closestOxygen.y ||
-             aa2.atom[i]->coord.z != closestOxygen.z)
-            {
-              otherOxygen = aa2.atom[i]->coord;
-            }
-        }
-    }
-
-  // Vector between benzene center of mass and closest oxygen
-  Coordinates oD  = closestOxygen - aa1.center[0];
-  // Vector between benzene center of mass and the other oxygen
-  Coordinates oD2 = otherOxygen - aa1.center[0];
-  
-  // Oxygen dot product
-  float oxy_numerator  = dotProduct(perp, oD); 
-  float oxy_numerator2 = dotProduct(perp, oD2); 
-
-  // distance from beneze center and the oxygens
-  float distFromCenterToOxy  = oD.norm();
-  float distFromCenterToOxy2 = oD2.norm();
-
-  // Denominators
-  float oxy_denom  = perpnorm * distFromCenterToOxy;
-  float oxy_denom2 = perpnorm * distFromCenterToOxy2;
-
-  if(oxy_denom == 0)
-    {
-      cerr << red << "Error" << reset << ": oxy_denom are zero.  Skipping residue" << endl;
-      return false;
-    }
-  
-  float u = num / denom;
-  float uOxy  = oxy_numerator  / oxy_denom;
-  float uOxy2 = oxy_numerator2 / oxy_denom2;
-
-  // Force u to be [-1,1]
-  if(u > 1)       u =  1;
-  else if(u < -1) u = -1;
-
-  if(uOxy > 1)       uOxy =  1;
-  else if(uOxy < -1) uOxy = -1;
-
-  if(uOxy2 > 1)       uOxy2 =  1;
-  else if(uOxy2 < -1) uOxy2 = -1;
-
-  // Get the angle and change it to degrees
-  // take absolute vale to put it in [0,90]
-  *dist      = distFromMassToChg;
-  *distOxy   = distFromCenterToOxy;
-  *distOxy2  = distFromCenterToOxy2;
-  *angle     = fabs( 90 - acos(u)     * 180/3.14159 );
-  *angleOxy  = fabs( 90 - acos(uOxy)  * 180/3.14159 );
-  *angleOxy2 = fabs( 90 - acos(uOxy2) * 180/3.14159 );
-  return true;
-}
-
-void AminoAcid::markAltLocAtomsPHEorTYR(int index)
-{
-  for(int i=0; i < this->atom.size(); i++)
-    {
-      if( this->atom[i]->name == " CG " &&
-          &this->atom[i]->coord != (this->center[index].plane_info[CG_PLANE_COORD_PTT]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " CD1" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[CD1_PLANE_COORD_PTT]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " CD2" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[CD2_PLANE_COORD_PTT]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " CZ " &&
-               &this->atom[i]->coord != (this->center[index].plane_info[3]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " CE1" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[4]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " CE2" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[5]))
-        {
-          this->atom[i]->skip = true;
-        }
-    }  
-}
-
-void AminoAcid::markAltLocAtomsASP(int index)
-{
-  for(int i=0; i < this->atom.size(); i++)
-    {
-      if( this->atom[i]->name == " CG " &&
-          &this->atom[i]->coord != (this->center[index].plane_info[C__PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " OD1" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[O_1_PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " OD2" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[O_2_PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-    }  
-}
-
-void AminoAcid::markAltLocAtomsGLU(int index)
-{
-  for(int i=0; i < this->atom.size(); i++)
-    {
-      if( this->atom[i]->name == " CD " &&
-          &this->atom[i]->coord != (this->center[index].plane_info[C__PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " OE1" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[O_1_PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " OE2" &&
-               &this->atom[i]->coord != (this->center[index].plane_info[O_2_PLANE_COORD_AG]))
-        {
-          this->atom[i]->skip = true;
-        }
-    }  
-}
-
-void AminoAcid::markAltLocAtomsPO4or2HPorPI(int index)
-{
-  for(int i=0; i < this->atom.size(); i++)
-    {
-      if( this->atom[i]->name == " P  " &&
-          &this->atom[i]->coord != (this->center[index].plane_info[0]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " O1 " &&
-               &this->atom[i]->coord != (this->center[index].plane_info[1]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " O2 " &&
-               &this->atom[i]->coord != (this->center[index].plane_info[2]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " O3 " &&
-               &this->atom[i]->coord != (this->center[index].plane_info[3]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( this->atom[i]->name == " O4 " &&
-               &this->atom[i]->coord != (this->center[index].plane_info[4]))
-        {
-          this->atom[i]->skip = true;
-        }
-    }  
-}
-
-void AminoAcid::markAltLocAtoms2POorPO3(int index)
-{
-  for(int i=0; i < this->atom.size(); i++)
-    {
-      if( this->atom[i]->name == " P  " &&
-          &this->atom[i]->coord != (this->center[index].plane_info[0]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( (this->atom[i]->name == " O1 " || this->atom[i]->name == " O1P") &&
-               &this->atom[i]->coord != (this->center[index].plane_info[1]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( (this->atom[i]->name == " O2 "  || this->atom[i]->name == " O2P") &&
-               &this->atom[i]->coord != (this->center[index].plane_info[2]))
-        {
-          this->atom[i]->skip = true;
-        }
-      else if( (this->atom[i]->name == " O3 "  || this->atom[i]->name == " O2P") &&
-               &this->atom[i]->coord != (this->center[index].plane_info[3]))
-        {
-          this->atom[i]->skip = true;
-        }
-    }  
-}
-
-void AminoAcid::markAltLocAtoms(int index)
-{
-  if(residue == "PHE" || residue == "TYR")
-    {
-      markAltLocAtomsPHEorTYR(index);
-    }
-  else if(residue == "ASP")
-    {
-      markAltLocAtomsASP(index);
-    }
-  else if(residue == "GLU")
-    {
-      markAltLocAtomsGLU(index);
-    }
-  else if(residue == "PO4" || residue == "2HP" || residue == " PI")
-    {
-      markAltLocAtomsPO4or2HPorPI(index);
-    }
-  else if(residue == "2PO" || residue == "PO3")
-    {
-      markAltLocAtoms2POorPO3(index);
-    }
-}
-
-void AminoAcid::unmarkAltLocAtomsPHEorTYR()
-{
-  for(int i=0; i < this->atom.size(); i++)
+  slots.assign(d->slots, vector<Atom*>());
+  for(unsigned int i =0; i< atom.size(); i++)
     {
-      if( this->atom[i]->name == " CG " )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " CD1" )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " CD2" )
+      int k = findSlot(d, atomCode(atom[i]->name));
+      if( k >= 0 )
         {
-          this->atom[i]->skip = false;
+          slots[k].push_back(atom[i]);
         }
-      else if( this->atom[i]->name == " CZ " )
+      else if( flagUnused )
         {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " CE1" )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " CE2" )
-        {
-          this->atom[i]->skip = false;
+          // This means that this atom is not useful so we flag it 
+          atom[i]->skip = true;
         }
-    }  
-}
+    }
 
-void AminoAcid::unmarkAltLocAtomsASP()
-{
-  for(int i=0; i < this->atom.size(); i++)
+  // Error check.  If we don't have at least one of each
+  // of the atoms, we throw a warning, set an ignore flag
+  // for future reference, and leave
+  for(unsigned int k=0; k<d->slots; k++)
     {
-      if( this->atom[i]->name == " CG " )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " OD1" )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " OD2" )
+      if( slots[k].empty() )
         {
-          this->atom[i]->skip = false;
+          skip = true;
+#ifndef DISABLE_WARNING
+          cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue << " at "
+               << atom[0]->resSeq << " chain " << atom[0]->chainID << endl;
+#endif
+          return false;
         }
-    }  
+    }
+  return true;
 }
 
-void AminoAcid::unmarkAltLocAtomsGLU()
+// Calculates the centers that the distances are measured to, the way
+// the table entry of the residue says to
+void AminoAcid::centerFromTable(const ResidueDescriptor* d)
 {
-  for(int i=0; i < this->atom.size(); i++)
+  vector< vector<Atom*> > slots;
+  if( !matchSlots(d, slots, true) )
+    {
+      return;
+    }
+
+  if( d->centers == CENTER_COMBINATIONS )
     {
-      if( this->atom[i]->name == " CD " )
+      for(unsigned int i =0; i< atom.size(); i++)
         {
-          this->atom[i]->skip = false;
+          if(atom[i]->altLoc != ' ')
+            {
+              altLoc = true;
+            }
         }
-      else if( this->atom[i]->name == " OE1" )
+
+      // The weights add up to what the center is divided by
+      AltLocCombinations all;
+      all.divisor = 0;
+      for(unsigned int k=0; k<d->slots; k++)
         {
-          this->atom[i]->skip = false;
+          all.addSlot(slots[k], d->weight[k]);
+          all.divisor += d->weight[k];
         }
-      else if( this->atom[i]->name == " OE2" )
+      all.planeSlots.assign(d->plane, d->plane + d->planeSlots);
+      buildCombinations(all);
+      return;
+    }
+
+  // Otherwise every conformer gets its own centers.  For CENTER_ATOMS
+  // the centers of the first weighted slot come first, one for each
+  // conformer, then those of the second, and so on
+  unsigned int numaltlocs = conformers();
+  if(numaltlocs > 1) this->altLoc = true;
+
+  vector<unsigned int> centerSlots;
+  for(unsigned int k=0; k<d->slots; k++)
+    {
+      if( d->centers == CENTER_ATOMS && d->weight[k] != 0 )
         {
-          this->atom[i]->skip = false;
+          centerSlots.push_back(k);
         }
-    }  
-}
+    }
+  unsigned int perConformer = d->centers == CENTER_ATOMS ? centerSlots.size() : 1;
+  center.resize(numaltlocs * perConformer);
 
-void AminoAcid::unmarkAltLocAtomsPO4or2HPorPI()
-{
-  for(int i=0; i < this->atom.size(); i++)
+  vector<Atom*> chosen;
+  for(unsigned int al = 0; al < numaltlocs; al++)
     {
-      if( this->atom[i]->name == " P  " )
+      chosen.assign(d->slots, (Atom*)NULL);
+      Coordinates sum(0,0,0);
+      float divisor = 0;
+      for(unsigned int i =0; i< atom.size(); i++)
         {
-          this->atom[i]->skip = false;
+          if( !inConformer(atom[i], al) )
+            {
+              continue;
+            }
+          int k = findSlot(d, atomCode(atom[i]->name));
+          if( k < 0 )
+            {
+              continue;
+            }
+          chosen[k] = atom[i];
+          sum += atom[i]->coord * d->weight[k];
+          divisor += d->weight[k];
         }
-      else if( this->atom[i]->name == " O1 " )
+
+      vector<Coordinates*> info(d->planeSlots, (Coordinates*)NULL);
+      for(unsigned int i=0; i<d->planeSlots; i++)
         {
-          this->atom[i]->skip = false;
+          if( chosen[d->plane[i]] )
+            {
+              info[i] = &chosen[d->plane[i]]->coord;
+            }
         }
-      else if( this->atom[i]->name == " O2 " )
+
+      bool complete = true;
+      for(unsigned int k=0; k<d->slots; k++)
         {
-          this->atom[i]->skip = false;
+          complete = complete && chosen[k];
         }
-      else if( this->atom[i]->name == " O3 " )
+      if( !complete )
         {
-          this->atom[i]->skip = false;
+          skip = true;
+#ifndef DISABLE_WARNING
+          cout << cyan << "WARNING" << reset << ": Could not find all atoms in the " << residue << " at "
+               << atom[0]->resSeq << " altLoc: " << conformerId(al) << endl;
+#endif
         }
-      else if( this->atom[i]->name == " O4 " )
+
+      for(unsigned int j=0; j<perConformer; j++)
         {
-          this->atom[i]->skip = false;
+          Coordinates& c = center[j*numaltlocs + al];
+          if( d->centers == CENTER_ATOMS )
+            {
+              c.set(0,0,0);
+              if( chosen[centerSlots[j]] )
+                {
+                  c = chosen[centerSlots[j]]->coord;
+                }
+            }
+          else
+            {
+              c = sum / divisor;
+            }
+          c.skip = false;
+          c.plane_info = info;
         }
-    }  
+    }
 }
 
-void AminoAcid::unmarkAltLocAtoms2POorPO3()
+// Calculates the center of charge of a residue with its hydrogens
+void AminoAcid::chargeCenterFromTable(const ResidueEntry* e)
 {
-  for(int i=0; i < this->atom.size(); i++)
+  const ResidueDescriptor* d = e->descriptor;
+  if( d->charges == CHARGE_NONE )
     {
-      if( this->atom[i]->name == " P  " )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " O1 "  || this->atom[i]->name == " O1P" )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " O2 "  || this->atom[i]->name == " O2P" )
-        {
-          this->atom[i]->skip = false;
-        }
-      else if( this->atom[i]->name == " O3 "  || this->atom[i]->name == " O3P" )
-        {
-          this->atom[i]->skip = false;
-        }
-    }  
-}
+      return;
+    }
 
-void AminoAcid::unmarkAltLocAtoms()
-{
-  if(residue == "PHE" || residue == "TYR")
+  vector< vector<Atom*> > slots;
+  if( !matchSlots(d, slots, false) )
+    {
+      return;
+    }
+
+  Coordinates weighted(0,0,0);
+  for(unsigned int k=0; k<d->slots; k++)
     {
-      unmarkAltLocAtomsPHEorTYR();
+      if( d->chargeWeight[k] != 0 )
+        {
+          weighted += slots[k].back()->coord * d->chargeWeight[k];
+        }
     }
-  else if(residue == "ASP")
+  Coordinates hydrogens(0,0,0);
+  unsigned int numHydrogens = 0;
+  for(unsigned int i =0; i< atom.size(); i++)
     {
-      unmarkAltLocAtomsASP();
+      if( atomCode(atom[i]->name) == HYDROGEN_CODE )
+        {
+          hydrogens += atom[i]->coord;
+          numHydrogens++;
+        }
     }
-  else if(residue == "GLU")
+
+  center.resize(1);
+  center[0].skip = false;
+  center[0].plane_info.resize(d->chargePlaneSlots);
+  for(unsigned int i=0; i<d->chargePlaneSlots; i++)
     {
-      unmarkAltLocAtomsGLU();
+      center[0].plane_info[i] = &slots[d->chargePlane[i]].back()->coord;
     }
-  else if(residue == "PO4" || residue == "2HP" || residue == " PI")
+
+  if( d->charges == CHARGE_CARBOXYLATE )
     {
-      unmarkAltLocAtomsPO4or2HPorPI();
+      // The weighted slot is the carbon
+      Coordinates away = weighted - hydrogens;
+      center[0] = weighted + (away * HYDROGEN_BOND_DISTANCE) / away.norm();
+      return;
     }
-  else if(residue == "2PO" || residue == "PO3")
+
+  if( d->hydrogenCharge != 0 && numHydrogens == 0 )
     {
-      unmarkAltLocAtoms2POorPO3();
+      skip = true;
+#ifndef DISABLE_WARNING
+      cout << cyan << "WARNING" << reset << ": Could not find any hydrogens in the " << residue << " at "
+           << atom[0]->resSeq << " chain " << atom[0]->chainID << endl;
+#endif
+      return;
     }
+  // Here is an estimate of the center by doing a charge weighted average
+  // divided by the formal charge
+  center[0] = (weighted + hydrogens * d->hydrogenCharge) / e->chargeDivisor;
 }
 
-string AminoAcid::makeConectPHEorTYR()
+// Builds the centers of a ring from its alternate location combinations.
+// A few of them are all built, like the nested loops used to.  With more
+// than that (a TRP with two locations for each ring atom has 512) only
+// the combinations that follow one alternate location id are built now,
+// and addClosestCombinations builds the others that turn out to be the
+// closest to a partner
+void AminoAcid::buildCombinations(AltLocCombinations& all)
 {
-  string serials[6];
-  for(int i=0; i<this->atom.size(); i++)
+  combinations.clear();
+  spread = 0;
+  built = 0;
+  vector<unsigned int> choice;
+  if( all.count() <= ALTLOC_EAGER_LIMIT )
     {
-      if( this->atom[i]->name == " CG " && !this->atom[i]->skip )
-        {
-          serials[0] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " CD1"  && !this->atom[i]->skip )
-        {
-          serials[1] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " CD2"  && !this->atom[i]->skip )
-        {
-          serials[2] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " CZ " && !this->atom[i]->skip )
-        {
-          serials[3] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " CE1" && !this->atom[i]->skip )
+      center.resize((unsigned int)all.count());
+      unsigned int index = 0;
+      all.first(choice);
+      do
         {
-          serials[4] = this->atom[i]->line.substr(6,5);
+          all.build(choice, &center[index++]);
         }
-      else if( this->atom[i]->name == " CE2" && !this->atom[i]->skip )
+      while( all.next(choice) );
+      return;
+    }
+
+  vector<char> ids;
+  for(unsigned int k=0; k<all.slots.size(); k++)
+    {
+      for(unsigned int o=0; o<all.slots[k].size(); o++)
         {
-          serials[5] = this->atom[i]->line.substr(6,5);
+          char id = all.slots[k][o]->altLoc;
+          if( id != ' ' && find(ids.begin(), ids.end(), id) == ids.end() )
+            {
+              ids.push_back(id);
+            }
         }
     }
-  string conect = "CONECT" + serials[0] + serials[2] + serials[1] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[4] + serials[0] + "                                                 \n";
-  conect += "CONECT" + serials[2] + serials[5] + serials[0] + "                                                 \n";
-  conect += "CONECT" + serials[3] + serials[5] + serials[4] + "                                                 \n";
-  conect += "CONECT" + serials[4] + serials[1] + serials[3] + "                                                 \n";
-  conect += "CONECT" + serials[5] + serials[2] + serials[3] + "                                                 \n";
-  return conect;
+  center.resize(ids.size());
+  for(unsigned int i=0; i<ids.size(); i++)
+    {
+      all.follow(ids[i], choice);
+      all.build(choice, &center[i]);
+    }
+  combinations = all;
+  spread = all.spread();
 }
 
-string AminoAcid::makeConectPHEorTYR_altloc(int c)
+// The combination closest to each target is found by branch and bound
+// and only built if it beats every center there already is
+void AminoAcid::addClosestCombinations(const vector<Coordinates>& targets, float limit)
 {
-  string serials[6];
-  for(int i=0; i<this->altlocs[c].size(); i++)
+  if( combinations.empty() )
     {
-      if( this->altlocs[c][i]->name == " CG " && !this->altlocs[c][i]->skip )
-        {
-          serials[0] = this->altlocs[c][i]->line.substr(6,5);
-        }
-      else if( this->altlocs[c][i]->name == " CD1"  && !this->altlocs[c][i]->skip )
+      return;
+    }
+  bool added = false;
+  vector<unsigned int> choice;
+  for(unsigned int t=0; t<targets.size(); t++)
+    {
+      if( targets[t].skip )
         {
-          serials[1] = this->altlocs[c][i]->line.substr(6,5);
+          continue;
         }
-      else if( this->altlocs[c][i]->name == " CD2"  && !this->altlocs[c][i]->skip )
+      Coordinates target = targets[t];
+      float best = limit;
+      for(unsigned int i=0; i<center.size(); i++)
         {
-          serials[2] = this->altlocs[c][i]->line.substr(6,5);
+          if( !center[i].skip )
+            {
+              best = fmin(best, center[i].distance(target));
+            }
         }
-      else if( this->altlocs[c][i]->name == " CZ " && !this->altlocs[c][i]->skip )
+      if( !combinations.closest(target, best, choice) )
         {
-          serials[3] = this->altlocs[c][i]->line.substr(6,5);
+          continue;
         }
-      else if( this->altlocs[c][i]->name == " CE1" && !this->altlocs[c][i]->skip )
+      if( built == ALTLOC_BUILT_CAP )
         {
-          serials[4] = this->altlocs[c][i]->line.substr(6,5);
+#ifndef DISABLE_WARNING
+          cout << cyan << "WARNING" << reset << ": " << residue << " " << atom[0]->resSeq
+               << " has " << combinations.count() << " alternate location combinations;"
+               << " only the closest " << ALTLOC_BUILT_CAP << " are used" << endl;
+#endif
+          built++;
         }
-      else if( this->altlocs[c][i]->name == " CE2" && !this->altlocs[c][i]->skip )
+      if( built > ALTLOC_BUILT_CAP )
         {
-          serials[5] = this->altlocs[c][i]->line.substr(6,5);
+          break;
         }
+      center.push_back(Coordinates());
+      combinations.build(choice, &center.back());
+      built++;
+      added = true;
+    }
+  if( added )
+    {
+      calculatePlanes();
     }
-  string conect = "CONECT" + serials[0] + serials[2] + serials[1] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[4] + serials[0] + "                                                 \n";
-  conect += "CONECT" + serials[2] + serials[5] + serials[0] + "                                                 \n";
-  conect += "CONECT" + serials[3] + serials[5] + serials[4] + "                                                 \n";
-  conect += "CONECT" + serials[4] + serials[1] + serials[3] + "                                                 \n";
-  conect += "CONECT" + serials[5] + serials[2] + serials[3] + "                                                 \n";
-  return conect;
 }
 
-string AminoAcid::makeConectGLU()
+// Works out which conformers every atom is part of.  An atom with an
+// alternate location id is only in the conformer with that id, the
+// others are in all of them.  Nothing is copied or flagged, so any
+// number of callers can look at different conformers at once
+void AminoAcid::determineAltLoc(vector<char>&altloc_ids)
 {
-  string serials[3];
-  for(int i=0; i<this->atom.size(); i++)
+  altlocIds = altloc_ids;
+  if(altlocIds.size() > MAX_ALTLOCS)
     {
-      if( this->atom[i]->name == " CD " && !this->atom[i]->skip )
-        {
-          serials[0] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " OE1"  && !this->atom[i]->skip )
+#ifndef DISABLE_WARNING
+      cout << cyan << "WARNING" << reset << ": Only the first " << MAX_ALTLOCS
+           << " alternate locations are used for residue " << atom[0]->resSeq << endl;
+#endif
+      altlocIds.resize(MAX_ALTLOCS);
+    }
+
+  for(unsigned int i=0; i<this->atom.size(); i++)
+    {
+      this->atom[i]->skip = false;
+      if(this->atom[i]->altLoc == ' ' || altlocIds.empty())
         {
-          serials[1] = this->atom[i]->line.substr(6,5);
+          this->atom[i]->altLocMask = ALTLOC_MASK_ALL;
+          continue;
         }
-      else if( this->atom[i]->name == " OE2"  && !this->atom[i]->skip )
+
+      // Ids past MAX_ALTLOCS are in no conformer at all
+      this->atom[i]->altLocMask = 0;
+      for(unsigned int c=0; c<altlocIds.size(); c++)
         {
-          serials[2] = this->atom[i]->line.substr(6,5);
+          if(altlocIds[c] == this->atom[i]->altLoc)
+            {
+              this->atom[i]->altLocMask = 1u << c;
+              break;
+            }
         }
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  return conect;
 }
 
-string AminoAcid::makeConectGLU_altloc(int c)
+// Returns the number of conformers, which is 1 for a residue
+// without alternate locations
+unsigned int AminoAcid::conformers() const
+{
+  return altlocIds.empty() ? 1 : altlocIds.size();
+}
+
+// Returns the alternate location id of conformer c, or a blank
+// if the residue has none
+char AminoAcid::conformerId(unsigned int c) const
+{
+  return c < altlocIds.size() ? altlocIds[c] : ' ';
+}
+
+// True if a is one of the atoms making up conformer c
+bool AminoAcid::inConformer(const Atom* a, unsigned int c) const
+{
+  return c < MAX_ALTLOCS && ( (a->altLocMask >> c) & 1u );
+}
+
+// Calculates the center of the amino acid from its entry in the
+// residue table.  Residues without one are skipped
+void AminoAcid::calculateCenter(bool centerOfCharge)
 {
-  string serials[3];
-  for(int i=0; i<this->altlocs[c].size(); i++)
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !centerOfCharge )
     {
-      if( this->altlocs[c][i]->name == " CD " && !this->altlocs[c][i]->skip )
-        {
-          serials[0] = this->altlocs[c][i]->line.substr(6,5);
-        }
-      else if( this->altlocs[c][i]->name == " OE1"  && !this->altlocs[c][i]->skip )
+      if( e )
         {
-          serials[1] = this->altlocs[c][i]->line.substr(6,5);
+          centerFromTable(e->descriptor);
         }
-      else if( this->altlocs[c][i]->name == " OE2"  && !this->altlocs[c][i]->skip )
+      // This is for all of other amino acids out there that we 
+      // don't support
+      else
         {
-          serials[2] = this->altlocs[c][i]->line.substr(6,5);
+          //cerr << red << "ERROR" << reset << ": " << residue << " is not yet supported." << endl;
+          skip = true;
         }
+      calculatePlanes();
+    }
+  // Now we are going to calculate the center of charges for the formate
+  else if( e )
+    {
+      chargeCenterFromTable(e);
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  return conect;
 }
 
-
-string AminoAcid::makeConectASP()
+// The aromatic planes go through CG, CD1, and CE2/CD2 in that order and
+// the anion planes through C, O1, and O2, which is the orientation the
+// angles have always been measured with
+void AminoAcid::calculatePlanes()
 {
-  string serials[3];
-  for(int i=0; i<this->atom.size(); i++)
+  bool aromatic = residue == "PHE" || residue == "TYR" || residue == "TRP";
+  plane.assign(center.size(), Plane());
+  for(unsigned int i=0; i<center.size(); i++)
     {
-      if( this->atom[i]->name == " CG " && !this->atom[i]->skip )
+      vector<Coordinates*>& info = center[i].plane_info;
+      if( info.size() < 3 || !info[0] || !info[1] || !info[2] )
         {
-          serials[0] = this->atom[i]->line.substr(6,5);
+          continue;
         }
-      else if( this->atom[i]->name == " OD1"  && !this->atom[i]->skip )
+      if( aromatic )
         {
-          serials[1] = this->atom[i]->line.substr(6,5);
+          plane[i].set( *info[ CG_PLANE_COORD_PTT],
+                        *info[CD1_PLANE_COORD_PTT],
+                        *info[C_2_PLANE_COORD_PTT] );
         }
-      else if( this->atom[i]->name == " OD2"  && !this->atom[i]->skip )
+      else
         {
-          serials[2] = this->atom[i]->line.substr(6,5);
+          plane[i].set( *info[ C__PLANE_COORD_AG],
+                        *info[O_1_PLANE_COORD_AG],
+                        *info[O_2_PLANE_COORD_AG] );
         }
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  return conect;
 }
 
-string AminoAcid::makeConectASP_altloc(int c)
+// Every center is an average of some of the atoms in the table entry
+// of the residue (or just one of them), so it can never be further from
+// the representative atom, the one in its first slot, than the furthest
+// of those atoms.  Residues without an entry use CB, or the first atom,
+// and all of their atoms
+void AminoAcid::setRepresentative()
 {
-  string serials[3];
-  for(int i=0; i<this->altlocs[c].size(); i++)
+  const ResidueEntry* e = findResidueEntry(residue);
+  const ResidueDescriptor* d = e ? e->descriptor : NULL;
+
+  unsigned int repCode = d ? d->name[0][0] : ATOM_CODE(' ','C','B',' ');
+  representative = NULL;
+  pad = 0;
+  for(unsigned int i=0; i<atom.size() && !representative; i++)
     {
-      if( this->altlocs[c][i]->name == " CG " && !this->altlocs[c][i]->skip )
+      if( atomCode(atom[i]->name) == repCode )
         {
-          serials[0] = this->altlocs[c][i]->line.substr(6,5);
+          representative = atom[i];
         }
-      else if( this->altlocs[c][i]->name == " OD1"  && !this->altlocs[c][i]->skip )
+    }
+  if( !representative )
+    {
+      if( atom.empty() )
         {
-          serials[1] = this->altlocs[c][i]->line.substr(6,5);
+          return;
         }
-      else if( this->altlocs[c][i]->name == " OD2"  && !this->altlocs[c][i]->skip )
+      representative = atom[0];
+    }
+
+  for(unsigned int i=0; i<atom.size(); i++)
+    {
+      if( !d || findSlot(d, atomCode(atom[i]->name)) >= 0 )
         {
-          serials[2] = this->altlocs[c][i]->line.substr(6,5);
+          pad = fmax(pad, representative->coord.distance(atom[i]->coord));
         }
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + "                                                 \n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  return conect;
 }
 
+void AminoAcid::ensureCenter()
+{
+  if( !centered )
+    {
+      centered = true;
+      calculateCenter(false);
+    }
+}
+
+// A pair at a time through the same kernels that batches of pairs use.
+// The pair kernels hand theirs to a PairQueue instead, which measures
+// all of the pairs it holds together
+void AminoAcid::calculateAnglesPreHydrogens(AminoAcid& aa2,
+                                            int index1,
+                                            int index2,
+                                            float* angle,
+                                            float* angle1,
+                                            float* angleP)
+{
+  AngleBatch batch;
+  batch.add(*this, aa2, index1, index2);
+  batch.run();
+
+  *angle  = batch.angle[0];
+  *angle1 = batch.angle1[0];
+  *angleP = batch.angleP[0];
+}
 
-string AminoAcid::makeConectPO4or2HPorPI()
+// The atoms of conformer c that are handed to Babel: the ones of that
+// conformer the table entry has a slot for
+void AminoAcid::conformerAtoms(int c, vector<Atom*>& given)
 {
-  string serials[5];
-  for(int i=0; i<this->atom.size(); i++)
+  given.clear();
+  for(unsigned int i=0; i<this->atom.size(); i++)
     {
-      if( this->atom[i]->name == " P  " && !this->atom[i]->skip )
-        {
-          serials[0] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " O1 "  && !this->atom[i]->skip )
-        {
-          serials[1] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " O2 "  && !this->atom[i]->skip )
-        {
-          serials[2] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " O3 "  && !this->atom[i]->skip )
-        {
-          serials[3] = this->atom[i]->line.substr(6,5);
-        }
-      else if( this->atom[i]->name == " O4 "  && !this->atom[i]->skip )
+      if( c >= 0 && inConformer(this->atom[i], c) && !this->atom[i]->skip )
         {
-          serials[4] = this->atom[i]->line.substr(6,5);
+          given.push_back(this->atom[i]);
         }
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + serials[3] + serials[4] + "\n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[3] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[4] + serials[0] + "                                                       \n";
-  return conect;
 }
 
-string AminoAcid::makeConect2POorPO3()
+// The altLoc of a combination center has the alternate location of each
+// slot in order (see AltLocCombinations::build), so every slot gets the
+// atom with that id.  Atoms without a slot follow the first one.  A
+// center without a combination behind it gets the first conformer
+void AminoAcid::combinationAtoms(unsigned int c, vector<Atom*>& given)
 {
-  string serials[5];
-  for(int i=0; i<this->atom.size(); i++)
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !e || e->descriptor->centers != CENTER_COMBINATIONS ||
+      c >= center.size() || center[c].altLoc.size() != e->descriptor->slots )
     {
-      if( (this->atom[i]->name == " P  ") && !this->atom[i]->skip )
-        {
-          serials[0] = this->atom[i]->line.substr(6,5);
-        }
-      else if( (this->atom[i]->name == " O1 " || this->atom[i]->name == " O1P" )  && !this->atom[i]->skip )
-        {
-          serials[1] = this->atom[i]->line.substr(6,5);
-        }
-      else if( (this->atom[i]->name == " O2 " || this->atom[i]->name == " O1P" )  && !this->atom[i]->skip )
+      conformerAtoms(0, given);
+      return;
+    }
+
+  const string& ids = center[c].altLoc;
+  given.clear();
+  for(unsigned int i=0; i<this->atom.size(); i++)
+    {
+      if( this->atom[i]->skip )
         {
-          serials[2] = this->atom[i]->line.substr(6,5);
+          continue;
         }
-      else if( (this->atom[i]->name == " O3 " || this->atom[i]->name == " O1P" )  && !this->atom[i]->skip )
+      int k = findSlot(e->descriptor, atomCode(this->atom[i]->name));
+      char id = k >= 0 ? ids[k] : ids[0];
+      if( this->atom[i]->altLoc == id || ( k < 0 && this->atom[i]->altLoc == ' ' ) )
         {
-          serials[3] = this->atom[i]->line.substr(6,5);
+          given.push_back(this->atom[i]);
         }
     }
-  string conect = "CONECT" + serials[0] + serials[1] + serials[2] + serials[3] + "      \n";
-  conect += "CONECT" + serials[1] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[2] + serials[0] + "                                                       \n";
-  conect += "CONECT" + serials[3] + serials[0] + "                                                       \n";
-  return conect;
 }
 
-string AminoAcid::makeConect(int c)
+// The carboxylate center is HYDROGEN_BOND_DISTANCE from the carbon
+// whichever way the hydrogen points, and a weighted center that leaves
+// the hydrogens out is known exactly.  The slots are filled the way they
+// are in the protonated pair, where only the atoms given are left
+bool AminoAcid::chargeCenterBound(const vector<Atom*>& given, Coordinates* point, float* radius)
 {
-  if(residue == "PHE" || residue == "TYR")
-    {
-      return makeConectPHEorTYR_altloc(c);
-    }
-  else if(residue == "ASP")
-    {
-      return makeConectASP();
-    }
-  else if(residue == "GLU")
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !e )
     {
-      return makeConectGLU_altloc(c);
+      return false;
     }
-  else if(residue == "PO4" || residue == "2HP" || residue == " PI")
+  const ResidueDescriptor* d = e->descriptor;
+  if( d->charges == CHARGE_NONE || ( d->charges == CHARGE_WEIGHTED && d->hydrogenCharge != 0 ) )
     {
-      return makeConectPO4or2HPorPI();
+      return false;
     }
-  else if(residue == "2PO" || residue == "PO3")
+
+  Atom* slot[MAX_RESIDUE_SLOTS];
+  for(unsigned int k=0; k<MAX_RESIDUE_SLOTS; k++)
     {
-      return makeConect2POorPO3();
+      slot[k] = NULL;
     }
-}
-
-// This checks the validity of the hydrogens for 
-// GLU and ASP residues.  Sometimes babel will add 4 hydrogens:
-// 2 to C and 1 to each O.  We can figure out why, but we came
-// up with this hackish fix.  We take the 2 that are connected
-// to the carbon, average them, and use that as the coordinates 
-// for the hydrogen that we are looking for.  We then throw all
-// of the other hydrogens away.
-bool AminoAcid::removeExcessHydrogens(vector<string> conect)
-{
-  if( !(residue == "GLU" || residue == "ASP") )
-    return false;
-  
-  vector<Atom*>::iterator it;
-  int carbonSerialNumber;
-  int hydrogenCount = 0;
-  for(it = atom.begin(); it != atom.end(); ++it)
+  for(unsigned int i=0; i<given.size(); i++)
     {
-      if( (*it)->name == " CG " || (*it)->name == " CD " )
-        {
-          carbonSerialNumber = (*it)->serialNumber;
-        }
-      else if( (*it)->name == " H  " )
+      int k = findSlot(d, atomCode(given[i]->name));
+      if( k >= 0 )
         {
-          hydrogenCount++;
+          slot[k] = given[i];
         }
     }
-  corrected = false;
-  if( hydrogenCount > 1 )
+
+  Coordinates weighted(0,0,0);
+  for(unsigned int k=0; k<d->slots; k++)
     {
-      corrected = true;
-      Coordinates avg(0,0,0);
-      vector<string>::iterator conectit;
-      Atom* lastHydrogen;
-      for(it = atom.begin(); it < atom.end(); ++it)
+      if( d->chargeWeight[k] != 0 )
         {
-          for(conectit = conect.begin(); conectit < conect.end(); ++conectit)
-            {
-              int number;
-              int cnumber;
-              if(!from_string<int>(number,(*conectit).substr(7,5),dec))
-                {
-                  cerr << red << "Error" << reset << ": failed to convert serial number into an int"  << endl;
-                }
-              string tempstr = (*conectit).substr(11,5);
-              if(tempstr != "     ")
-                {
-                  if(!from_string<int>(cnumber,(*conectit).substr(11,5),dec))
-                    {
-                      cerr << red << "Error" << reset << ": failed to convert serial number into an int "  << endl;
-                    }
-
-                  if( (*it)->name == " H  " && (*it)->serialNumber == number 
-                      && cnumber == carbonSerialNumber )
-                    {
-                      avg += (*it)->coord;
-                    }
-                }
-            }
-          if((*it)->name == " H  " )
+          if( !slot[k] )
             {
-              lastHydrogen = (*it);
-              vector<Atom*>::iterator tempit = it-1;
-              atom.erase(it);
-              it = tempit;
+              return false;
             }
+          weighted += slot[k]->coord * d->chargeWeight[k];
         }
-      avg /= 2;
-      lastHydrogen->coord = avg;
-      char cstr[25];
-      sprintf(cstr,"%8.3lf%8.3lf%8.3lf",avg.x, avg.y, avg.z);
-      string temp(cstr);
-      lastHydrogen->line = lastHydrogen->line.substr(0,30) + 
-        temp.substr(0,24) + lastHydrogen->line.substr(54,26);
-      atom.push_back(lastHydrogen);
     }
-  return corrected;
-}
 
-void AminoAcid::printPHEorTYR(FILE* output)
-{
-  for(int i=0; i < this->atom.size(); i++)
+  if( d->charges == CHARGE_CARBOXYLATE )
     {
-      if((atom[i]->name == " CD1" || 
-          atom[i]->name == " CD2" || 
-          atom[i]->name == " CE1" || 
-          atom[i]->name == " CE2" || 
-          atom[i]->name == " CZ " ||
-          atom[i]->name == " CG ") && !atom[i]->skip)
-        {
-          this->atom[i]->print(output);
-        }
+      *point  = weighted;
+      *radius = HYDROGEN_BOND_DISTANCE;
+    }
+  else
+    {
+      *point  = weighted / e->chargeDivisor;
+      *radius = 0;
     }
+  return true;
 }
 
-void AminoAcid::printASP(FILE* output)
+// The bonds of the table entry between the atoms given, as pairs of
+// indices into given.  The last atom filling a slot is the one bonded
+void AminoAcid::tableBonds(const vector<Atom*>& given, vector<pair<int,int> >& bonds)
 {
-  for(int i=0; i < this->atom.size(); i++)
+  bonds.clear();
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !e )
+    {
+      return;
+    }
+  const ResidueDescriptor* d = e->descriptor;
+
+  int index[MAX_RESIDUE_SLOTS];
+  for(unsigned int k=0; k<MAX_RESIDUE_SLOTS; k++)
     {
-      if((atom[i]->name == " OD1" || 
-         atom[i]->name == " OD2" || 
-         atom[i]->name == " CG " ) && !atom[i]->skip)
+      index[k] = -1;
+    }
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      int k = findSlot(d, atomCode(given[i]->name));
+      if( k >= 0 )
         {
-          this->atom[i]->print(output);
+          index[k] = i;
         }
     }
-}
 
-void AminoAcid::printGLU(FILE* output)
-{
-  for(int i=0; i < this->atom.size(); i++)
+  for(unsigned int l=0; l<d->conectLines; l++)
     {
-      if((atom[i]->name == " OE1" || 
-         atom[i]->name == " OE2" || 
-         atom[i]->name == " CD " )&& !atom[i]->skip)
+      int a = index[d->conect[l][0]];
+      for(unsigned int j=1; j<MAX_BONDED+2 && d->conect[l][j] >= 0; j++)
         {
-          this->atom[i]->print(output);
+          int b = index[d->conect[l][j]];
+          if( a < 0 || b < 0 )
+            {
+              continue;
+            }
+          pair<int,int> bond(min(a,b), max(a,b));
+          if( find(bonds.begin(), bonds.end(), bond) == bonds.end() )
+            {
+              bonds.push_back(bond);
+            }
         }
     }
 }
 
+// Prints the atoms the centers are made of
 void AminoAcid::printNeededAtoms(FILE* output)
 {
-
-  if(residue == "PHE" || residue == "TYR")
-    {
-      printPHEorTYR(output);
-    }
-  else if(residue == "ASP")
-    {
-      printASP(output);
-    }
-  else if(residue == "GLU")
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !e )
     {
-      printGLU(output);
+      cerr << red << "Error" << reset << ": Unsupported residue" << endl;
+      return;
     }
-  else
+  for(int i=0; i < this->atom.size(); i++)
     {
-      cerr << red << "Error" << reset << ": Unsupported residue" << endl;
+      if( findSlot(e->descriptor, atomCode(atom[i]->name)) >= 0 && !atom[i]->skip )
+        {
+          this->atom[i]->print(output);
+        }
     }
 }
 
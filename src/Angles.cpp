@@ -0,0 +1,399 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Angles.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the AngleBatch class
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cfloat>
+#include <cmath>
+#include "Angles.hpp"
+#include "CoutColors.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+// Cosines outside of -1 and 1 by no more than this are rounding errors
+#define COSINE_SLACK 1e-5
+
+// acos(x) = sqrt(1 - x) * p(x) for 0 <= x <= 1, with the polynomial from
+// Abramowitz and Stegun 4.4.46, and acos(-x) = pi - acos(x).  The
+// polynomial is good to 2e-8 but the float arithmetic is not: over every
+// float in -1 to 1 the result is within 5e-7 radians (3e-5 degrees) of
+// acos, as scripts/checkAngles.d/checkAngles.sh shows.  Every kernel
+// evaluates it in the same order without fused multiply-adds, so they
+// all give the same answer
+static const float ACOS0 =  1.5707963050f;
+static const float ACOS1 = -0.2145988016f;
+static const float ACOS2 =  0.0889789874f;
+static const float ACOS3 = -0.0501743046f;
+static const float ACOS4 =  0.0308918810f;
+static const float ACOS5 = -0.0170881256f;
+static const float ACOS6 =  0.0066700901f;
+static const float ACOS7 = -0.0012624911f;
+static const float ACOS_PI = 3.14159265358979f;
+
+// The inputs of the cosine kernels
+class AngleArrays
+{
+public:
+  const float *nx, *ny, *nz, *d;
+  const float *cx, *cy, *cz;
+  const float *gx, *gy, *gz;
+  const float *px, *py, *pz;
+  const float *mx, *my, *mz;
+};
+
+typedef void (*CosineKernel)(const AngleArrays& in, unsigned int k, unsigned int n,
+                             float* cosA, float* cos1, float* cosP);
+typedef void (*ArccosKernel)(const float* x, unsigned int k, unsigned int n, float* y);
+
+static void cosinesScalar(const AngleArrays& in, unsigned int k, unsigned int n,
+                          float* cosA, float* cos1, float* cosP)
+{
+  for(; k<n; k++)
+    {
+      // line between the centers against the ring normal
+      float vx = in.px[k] - in.cx[k];
+      float vy = in.py[k] - in.cy[k];
+      float vz = in.pz[k] - in.cz[k];
+      float nv = (in.nx[k]*vx + in.ny[k]*vy) + in.nz[k]*vz;
+      float vv = (vx*vx + vy*vy) + vz*vz;
+      cosA[k] = nv / sqrtf(vv);
+
+      // anion center dropped onto the ring plane
+      float s  = ((in.nx[k]*in.px[k] + in.ny[k]*in.py[k]) + in.nz[k]*in.pz[k]) + in.d[k];
+      float wx = (in.px[k] - in.nx[k]*s) - in.cx[k];
+      float wy = (in.py[k] - in.ny[k]*s) - in.cy[k];
+      float wz = (in.pz[k] - in.nz[k]*s) - in.cz[k];
+      float ux = in.gx[k] - in.cx[k];
+      float uy = in.gy[k] - in.cy[k];
+      float uz = in.gz[k] - in.cz[k];
+      float uw = (ux*wx + uy*wy) + uz*wz;
+      float uu = (ux*ux + uy*uy) + uz*uz;
+      float ww = (wx*wx + wy*wy) + wz*wz;
+      cos1[k] = uw / (sqrtf(uu) * sqrtf(ww));
+
+      // the two normals
+      cosP[k] = (in.nx[k]*in.mx[k] + in.ny[k]*in.my[k]) + in.nz[k]*in.mz[k];
+    }
+}
+
+static void arccosScalar(const float* x, unsigned int k, unsigned int n, float* y)
+{
+  for(; k<n; k++)
+    {
+      float a = fabsf(x[k]);
+      float p = ACOS7;
+      p = p*a + ACOS6;
+      p = p*a + ACOS5;
+      p = p*a + ACOS4;
+      p = p*a + ACOS3;
+      p = p*a + ACOS2;
+      p = p*a + ACOS1;
+      p = p*a + ACOS0;
+      float r = sqrtf(1.0f - a) * p;
+      y[k] = x[k] < 0 ? ACOS_PI - r : r;
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+// SSE is always there on x86-64
+static void cosinesSSE(const AngleArrays& in, unsigned int k, unsigned int n,
+                       float* cosA, float* cos1, float* cosP)
+{
+  for(; k+4 <= n; k+=4)
+    {
+      __m128 nx = _mm_loadu_ps(in.nx+k), ny = _mm_loadu_ps(in.ny+k), nz = _mm_loadu_ps(in.nz+k);
+      __m128 cx = _mm_loadu_ps(in.cx+k), cy = _mm_loadu_ps(in.cy+k), cz = _mm_loadu_ps(in.cz+k);
+      __m128 px = _mm_loadu_ps(in.px+k), py = _mm_loadu_ps(in.py+k), pz = _mm_loadu_ps(in.pz+k);
+
+      __m128 vx = _mm_sub_ps(px, cx), vy = _mm_sub_ps(py, cy), vz = _mm_sub_ps(pz, cz);
+      __m128 nv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+      __m128 vv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+      _mm_storeu_ps(cosA+k, _mm_div_ps(nv, _mm_sqrt_ps(vv)));
+
+      __m128 s  = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)),
+                                        _mm_mul_ps(nz, pz)), _mm_loadu_ps(in.d+k));
+      __m128 wx = _mm_sub_ps(_mm_sub_ps(px, _mm_mul_ps(nx, s)), cx);
+      __m128 wy = _mm_sub_ps(_mm_sub_ps(py, _mm_mul_ps(ny, s)), cy);
+      __m128 wz = _mm_sub_ps(_mm_sub_ps(pz, _mm_mul_ps(nz, s)), cz);
+      __m128 ux = _mm_sub_ps(_mm_loadu_ps(in.gx+k), cx);
+      __m128 uy = _mm_sub_ps(_mm_loadu_ps(in.gy+k), cy);
+      __m128 uz = _mm_sub_ps(_mm_loadu_ps(in.gz+k), cz);
+      __m128 uw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, wx), _mm_mul_ps(uy, wy)), _mm_mul_ps(uz, wz));
+      __m128 uu = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, ux), _mm_mul_ps(uy, uy)), _mm_mul_ps(uz, uz));
+      __m128 ww = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wx, wx), _mm_mul_ps(wy, wy)), _mm_mul_ps(wz, wz));
+      _mm_storeu_ps(cos1+k, _mm_div_ps(uw, _mm_mul_ps(_mm_sqrt_ps(uu), _mm_sqrt_ps(ww))));
+
+      __m128 nm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(in.mx+k)),
+                                        _mm_mul_ps(ny, _mm_loadu_ps(in.my+k))),
+                             _mm_mul_ps(nz, _mm_loadu_ps(in.mz+k)));
+      _mm_storeu_ps(cosP+k, nm);
+    }
+  cosinesScalar(in, k, n, cosA, cos1, cosP);
+}
+
+static void arccosSSE(const float* x, unsigned int k, unsigned int n, float* y)
+{
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  for(; k+4 <= n; k+=4)
+    {
+      __m128 v = _mm_loadu_ps(x+k);
+      __m128 a = _mm_andnot_ps(sign, v);
+      __m128 p = _mm_set1_ps(ACOS7);
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS6));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS5));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS4));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS3));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS2));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS1));
+      p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS0));
+      __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+      __m128 negative = _mm_cmplt_ps(v, _mm_setzero_ps());
+      __m128 flipped  = _mm_sub_ps(_mm_set1_ps(ACOS_PI), r);
+      _mm_storeu_ps(y+k, _mm_or_ps(_mm_and_ps(negative, flipped), _mm_andnot_ps(negative, r)));
+    }
+  arccosScalar(x, k, n, y);
+}
+
+__attribute__((target("avx2")))
+static void cosinesAVX2(const AngleArrays& in, unsigned int k, unsigned int n,
+                        float* cosA, float* cos1, float* cosP)
+{
+  for(; k+8 <= n; k+=8)
+    {
+      __m256 nx = _mm256_loadu_ps(in.nx+k), ny = _mm256_loadu_ps(in.ny+k), nz = _mm256_loadu_ps(in.nz+k);
+      __m256 cx = _mm256_loadu_ps(in.cx+k), cy = _mm256_loadu_ps(in.cy+k), cz = _mm256_loadu_ps(in.cz+k);
+      __m256 px = _mm256_loadu_ps(in.px+k), py = _mm256_loadu_ps(in.py+k), pz = _mm256_loadu_ps(in.pz+k);
+
+      __m256 vx = _mm256_sub_ps(px, cx), vy = _mm256_sub_ps(py, cy), vz = _mm256_sub_ps(pz, cz);
+      __m256 nv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, vx), _mm256_mul_ps(ny, vy)), _mm256_mul_ps(nz, vz));
+      __m256 vv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz));
+      _mm256_storeu_ps(cosA+k, _mm256_div_ps(nv, _mm256_sqrt_ps(vv)));
+
+      __m256 s  = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, px), _mm256_mul_ps(ny, py)),
+                                              _mm256_mul_ps(nz, pz)), _mm256_loadu_ps(in.d+k));
+      __m256 wx = _mm256_sub_ps(_mm256_sub_ps(px, _mm256_mul_ps(nx, s)), cx);
+      __m256 wy = _mm256_sub_ps(_mm256_sub_ps(py, _mm256_mul_ps(ny, s)), cy);
+      __m256 wz = _mm256_sub_ps(_mm256_sub_ps(pz, _mm256_mul_ps(nz, s)), cz);
+      __m256 ux = _mm256_sub_ps(_mm256_loadu_ps(in.gx+k), cx);
+      __m256 uy = _mm256_sub_ps(_mm256_loadu_ps(in.gy+k), cy);
+      __m256 uz = _mm256_sub_ps(_mm256_loadu_ps(in.gz+k), cz);
+      __m256 uw = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux, wx), _mm256_mul_ps(uy, wy)), _mm256_mul_ps(uz, wz));
+      __m256 uu = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux, ux), _mm256_mul_ps(uy, uy)), _mm256_mul_ps(uz, uz));
+      __m256 ww = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wx, wx), _mm256_mul_ps(wy, wy)), _mm256_mul_ps(wz, wz));
+      _mm256_storeu_ps(cos1+k, _mm256_div_ps(uw, _mm256_mul_ps(_mm256_sqrt_ps(uu), _mm256_sqrt_ps(ww))));
+
+      __m256 nm = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(in.mx+k)),
+                                              _mm256_mul_ps(ny, _mm256_loadu_ps(in.my+k))),
+                                _mm256_mul_ps(nz, _mm256_loadu_ps(in.mz+k)));
+      _mm256_storeu_ps(cosP+k, nm);
+    }
+  cosinesSSE(in, k, n, cosA, cos1, cosP);
+}
+
+__attribute__((target("avx2")))
+static void arccosAVX2(const float* x, unsigned int k, unsigned int n, float* y)
+{
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  for(; k+8 <= n; k+=8)
+    {
+      __m256 v = _mm256_loadu_ps(x+k);
+      __m256 a = _mm256_andnot_ps(sign, v);
+      __m256 p = _mm256_set1_ps(ACOS7);
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS6));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS5));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS4));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS3));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS2));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS1));
+      p = _mm256_add_ps(_mm256_mul_ps(p, a), _mm256_set1_ps(ACOS0));
+      __m256 r = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), a)), p);
+      __m256 negative = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ);
+      _mm256_storeu_ps(y+k, _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(ACOS_PI), r), negative));
+    }
+  arccosSSE(x, k, n, y);
+}
+#endif
+
+// Picks the kernels the first time they are needed
+static const char* pickKernels(CosineKernel* cosines, ArccosKernel* arccos)
+{
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx2") )
+    {
+      *cosines = cosinesAVX2;
+      *arccos  = arccosAVX2;
+      return "avx2";
+    }
+  *cosines = cosinesSSE;
+  *arccos  = arccosSSE;
+  return "sse";
+#else
+  *cosines = cosinesScalar;
+  *arccos  = arccosScalar;
+  return "scalar";
+#endif
+}
+
+static CosineKernel cosineKernel = NULL;
+static ArccosKernel arccosKernel = NULL;
+static const char*  kernelName   = pickKernels(&cosineKernel, &arccosKernel);
+
+const char* angleKernelName()
+{
+  return kernelName;
+}
+
+void arccosBatch(const float* x, unsigned int n, float* y)
+{
+  arccosKernel(x, 0, n, y);
+}
+
+AngleBatch::AngleBatch()
+{
+  clear();
+}
+
+void AngleBatch::clear()
+{
+  nx.clear(); ny.clear(); nz.clear(); d.clear();
+  cx.clear(); cy.clear(); cz.clear();
+  gx.clear(); gy.clear(); gz.clear();
+  px.clear(); py.clear(); pz.clear();
+  mx.clear(); my.clear(); mz.clear();
+  angle.clear();
+  angle1.clear();
+  angleP.clear();
+}
+
+unsigned int AngleBatch::size() const
+{
+  return nx.size();
+}
+
+unsigned int AngleBatch::add(AminoAcid& a, AminoAcid& b, int index1, int index2)
+{
+  return add(a.plane[index1],
+             a.center[index1],
+             *a.center[index1].plane_info[CG_PLANE_COORD_PTT],
+             b.center[index2],
+             b.plane[index2]);
+}
+
+unsigned int AngleBatch::add(const Plane& ring,
+                             const Coordinates& center1,
+                             const Coordinates& cg,
+                             const Coordinates& center2,
+                             const Plane& anion)
+{
+  nx.push_back(ring.normal.x); ny.push_back(ring.normal.y); nz.push_back(ring.normal.z);
+  d.push_back(ring.offset);
+  cx.push_back(center1.x); cy.push_back(center1.y); cz.push_back(center1.z);
+  gx.push_back(cg.x);      gy.push_back(cg.y);      gz.push_back(cg.z);
+  px.push_back(center2.x); py.push_back(center2.y); pz.push_back(center2.z);
+  mx.push_back(anion.normal.x); my.push_back(anion.normal.y); mz.push_back(anion.normal.z);
+  return size() - 1;
+}
+
+// Rounding can push a cosine a hair past -1 or 1, which gets clamped.
+// Anything further out is reported the way the scalar functions in
+// Geometry do it.  Returns false for those
+static bool checkCosine(float* c)
+{
+  if( *c < -1 || *c > 1 )
+    {
+      if( fabs(*c) > 1 + COSINE_SLACK )
+        {
+          cerr << red << "Error" << reset << ":Error: Cosine of angle, " << *c << ", lies outside of -1 and 1" << endl;
+          return false;
+        }
+      *c = *c < 0 ? -1 : 1;
+    }
+  return true;
+}
+
+void AngleBatch::run()
+{
+  unsigned int n = size();
+  angle.assign(n, 1000);
+  angle1.assign(n, 1000);
+  angleP.assign(n, 1000);
+  if( !n )
+    {
+      return;
+    }
+
+  AngleArrays in;
+  in.nx = &nx[0]; in.ny = &ny[0]; in.nz = &nz[0]; in.d = &d[0];
+  in.cx = &cx[0]; in.cy = &cy[0]; in.cz = &cz[0];
+  in.gx = &gx[0]; in.gy = &gy[0]; in.gz = &gz[0];
+  in.px = &px[0]; in.py = &py[0]; in.pz = &pz[0];
+  in.mx = &mx[0]; in.my = &my[0]; in.mz = &mz[0];
+
+  cosine.resize(3*n);
+  cosineKernel(in, 0, n, &cosine[0], &cosine[n], &cosine[2*n]);
+
+  vector<bool> good(3*n);
+  for(unsigned int k=0; k<3*n; k++)
+    {
+      good[k] = checkCosine(&cosine[k]);
+    }
+
+  // All three sets of cosines go through the arccosine in one go
+  arccosKernel(&cosine[0], 0, 3*n, &cosine[0]);
+
+  for(unsigned int k=0; k<n; k++)
+    {
+      if( good[k] )
+        {
+          angle[k] = fabs( 90 - cosine[k] * 180 / 3.14159 );
+        }
+      if( good[n+k] )
+        {
+          angle1[k] = cosine[n+k] * 180 / 3.14159;
+        }
+      if( good[2*n+k] )
+        {
+          angleP[k] = cosine[2*n+k] * 180 / 3.14159;
+          if( angleP[k] > 90 )
+            {
+              angleP[k] = 180.0 - angleP[k];
+            }
+        }
+    }
+}
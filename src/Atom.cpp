@@ -45,6 +45,7 @@
 #include <string>
 #include "Atom.hpp"
 #include "Coordinates.hpp"
+#include "FixedPoint.hpp"
 #include "CoutColors.hpp"
 
 // Constructor setting everything to initial values
@@ -63,6 +64,7 @@ Atom::Atom()
   charge = "";
   failure = false;
   skip = false;
+  altLocMask = ALTLOC_MASK_ALL;
 }
 
 // Constructor that parses an ATOM line from a PDB file
@@ -94,6 +96,7 @@ Atom::~Atom()
   charge = "";
   failure = false;
   skip = false;
+  altLocMask = ALTLOC_MASK_ALL;
 }
 
 // Returns true if the parsing failed, false otherwise
@@ -112,6 +115,22 @@ void Atom::print()
        << element << " " << charge << " " << endl;
 }
 
+// Reads one 8 column coordinate field.  The usual %8.3f text is read
+// straight into thousandths, which gives the same float the stream
+// would have without building a stream; anything else still goes
+// through one
+static bool readCoordinate(const string& line, unsigned int start, float* value)
+{
+  int  milli;
+  bool negative;
+  if( parseFixedPoint(line, start, 8, &milli, &negative) )
+    {
+      *value = fixedPointToFloat(milli, negative);
+      return true;
+    }
+  return line.length() >= start + 8 && from_string<float>(*value, line.substr(start,8), dec);
+}
+
 // Parse the ATOM line of a PDB file
 void Atom::parseAtom(string line, int num)
 {
@@ -140,6 +159,7 @@ void Atom::parseAtom(string line, int num)
   // Grab the name, alternate location, residue name, and chain ID
   name = this->line.substr(12,4);
   altLoc = this->line[16];
+  altLocMask = ALTLOC_MASK_ALL;
   residueName = this->line.substr(17,3);
   chainID = this->line[21];
   if(chainID == ' ')
@@ -157,17 +177,17 @@ void Atom::parseAtom(string line, int num)
   iCode = line[26];
 
   // Grab the coordinates, occupancy and temperature factor
-  if(!from_string<float>(coord.x,this->line.substr(30,8),dec))
+  if(!readCoordinate(this->line, 30, &coord.x))
     {
       cerr << red << "Error" << reset << ": failed to convert x coordinate into a double" << endl;
       failure = true;
     }
-  if(!from_string<float>(coord.y,this->line.substr(38,8),dec))
+  if(!readCoordinate(this->line, 38, &coord.y))
     {
       cerr << red << "Error" << reset << ": failed to convert y coordinate into a double" << endl;
       failure = true;
     }
-  if(!from_string<float>(coord.z,this->line.substr(46,8),dec))
+  if(!readCoordinate(this->line, 46, &coord.z))
     {
       cerr << red << "Error" << reset << ": failed to convert z coordinate into a double" << endl;
       failure = true;
@@ -188,6 +208,20 @@ void Atom::parseAtom(string line, int num)
   charge = this->line.substr(78,2);
 
 }
+// Moves the atom to c and keeps columns 31-54 of the
+// stored line in step, since the line is what gets handed to Babel
+void Atom::setCoordinates(const Coordinates& c)
+{
+  coord.set(c.x, c.y, c.z);
+  if( line.length() < 54 )
+    {
+      return;
+    }
+  char cstr[25];
+  sprintf(cstr, "%8.3lf%8.3lf%8.3lf", coord.x, coord.y, coord.z);
+  line.replace(30, 24, string(cstr).substr(0,24));
+}
+
 // Outputs the ATOM line into a file
 void Atom::print(FILE* output)
 {
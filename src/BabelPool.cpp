@@ -0,0 +1,621 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: BabelPool.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Runs Babel's AddHydrogens on batches of residues, either in this process
+//               or in a pool of worker processes that are restarted if they crash or hang
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <algorithm>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/mol.h>
+#include <openbabel/obiter.h>
+#include <openbabel/data.h>
+#include "BabelPool.hpp"
+#include "PDB.hpp"
+#include "CoutColors.hpp"
+
+using namespace OpenBabel;
+
+// The messages between the main process and a worker are the arrays
+// of a batch and of the hydrogens added, copied as they are laid out in
+// memory.  Both ends are the same program, so nothing has to be
+// converted.
+//   request: BATCH_MAGIC, fragments, atoms, bond indices,
+//            then the BatchFragments, BatchAtoms, and bond indices
+//   reply:   REPLY_MAGIC, hydrogens, whether Babel was loaded for
+//            this batch and the microseconds that took, then the
+//            AddedHydrogens
+#define BATCH_MAGIC 0x48425453u  // "STBH"
+#define REPLY_MAGIC 0x52425453u  // "STBR"
+
+// What reading from or writing to a worker came to
+#define IO_OK       0
+#define IO_CLOSED   1            // The worker is gone
+#define IO_TIMEOUT  2            // It did not answer, or take the batch, in time
+
+string elementSymbol(const Atom& a)
+{
+  string symbol;
+  for(unsigned int i=0; i<a.element.size(); i++)
+    {
+      if( a.element[i] != ' ' )
+        {
+          symbol += a.element[i];
+        }
+    }
+  if( symbol.empty() && a.name.size() > 1 )
+    {
+      symbol = a.name.substr(1,1);
+    }
+  return symbol;
+}
+
+void HydrogenBatch::addFragment(AminoAcid& r, const vector<Atom*>& given)
+{
+  BatchFragment f;
+  memset(f.residue, ' ', sizeof(f.residue));
+  memcpy(f.residue, r.residue.data(), min(r.residue.size(), sizeof(f.residue)));
+  f.chain     = given.empty() ? ' ' : given[0]->chainID;
+  f.resSeq    = given.empty() ? 0 : given[0]->resSeq;
+  f.first     = atoms.size();
+  f.count     = given.size();
+  f.firstBond = bonds.size() / 2;
+
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      BatchAtom a;
+      string symbol = elementSymbol(*given[i]);
+      memset(a.element, ' ', sizeof(a.element));
+      memcpy(a.element, symbol.data(), min(symbol.size(), sizeof(a.element)));
+      memset(a.name, ' ', sizeof(a.name));
+      memcpy(a.name, given[i]->name.data(), min(given[i]->name.size(), sizeof(a.name)));
+      a.het = given[i]->line.compare(0, 6, "HETATM") == 0;
+      a.x   = given[i]->coord.x;
+      a.y   = given[i]->coord.y;
+      a.z   = given[i]->coord.z;
+      atoms.push_back(a);
+    }
+
+  vector<pair<int,int> > table;
+  r.tableBonds(given, table);
+  for(unsigned int i=0; i<table.size(); i++)
+    {
+      bonds.push_back(table[i].first);
+      bonds.push_back(table[i].second);
+    }
+  f.bonds = table.size();
+  fragments.push_back(f);
+}
+
+void HydrogenBatch::clear()
+{
+  fragments.clear();
+  atoms.clear();
+  bonds.clear();
+}
+
+// Seconds loadBabel took, negative until it has run
+static double loadSeconds = -1;
+
+// Loads Babel the first time a batch needs it, so that a run (or a
+// worker) that never protonates anything does not pay for finding the
+// plugins and reading the element table
+static void loadBabel()
+{
+  if( loadSeconds >= 0 )
+    {
+      return;
+    }
+  double start = getTime();
+
+  // This section is just to suppress all of the 
+  // warning message that aren't important to us
+  OBConversion apiConv;
+  OBFormat* pAPI = OBConversion::FindFormat("obapi");
+  if(pAPI)
+    {
+      apiConv.SetOutFormat(pAPI);
+      apiConv.AddOption("errorlevel", OBConversion::GENOPTIONS, "0");
+      apiConv.Write(NULL, &std::cout);
+    }
+
+  int isotope;
+  etab.GetAtomicNum("C", isotope);
+  loadSeconds = getTime() - start;
+}
+
+double babelLoadTime()
+{
+  return loadSeconds;
+}
+
+// Element number of an atom of a batch
+static int atomicNumber(const BatchAtom& a)
+{
+  int isotope;
+  return etab.GetAtomicNum(string(a.element, a.element[1] == ' ' ? 1 : 2).c_str(), isotope);
+}
+
+// Bonds a fragment the way Babel's PDB reader bonds a residue read on
+// its own: the table bonds (its CONECT lines) and then ConnectTheDots.
+// That is done in a molecule of just the fragment, since in one with
+// other residues ConnectTheDots would bond them to each other, and the
+// bonds are copied into mol.  A residue gets the same bonds whether it
+// is protonated alone or with the rest of its model
+static void bondFragment(const HydrogenBatch& batch, const BatchFragment& fragment, OBMol& mol)
+{
+  OBMol alone;
+  alone.BeginModify();
+  for(unsigned int i=fragment.first; i<fragment.first+fragment.count; i++)
+    {
+      const BatchAtom& a = batch.atoms[i];
+      OBAtom* atom = alone.NewAtom();
+      atom->SetAtomicNum(atomicNumber(a));
+      atom->SetVector(a.x, a.y, a.z);
+    }
+  for(unsigned int b=fragment.firstBond; b<fragment.firstBond+fragment.bonds; b++)
+    {
+      alone.AddBond(batch.bonds[2*b] + 1, batch.bonds[2*b+1] + 1, 1);
+    }
+  alone.EndModify();
+  alone.ConnectTheDots();
+
+  for(unsigned int b=0; b<alone.NumBonds(); b++)
+    {
+      OBBond* bond = alone.GetBond(b);
+      mol.AddBond(fragment.first + bond->GetBeginAtomIdx(),
+                  fragment.first + bond->GetEndAtomIdx(),
+                  bond->GetBondOrder());
+    }
+}
+
+void protonateBatch(const HydrogenBatch& batch, vector<AddedHydrogen>& added)
+{
+  added.clear();
+  if( batch.atoms.empty() )
+    {
+      return;
+    }
+  loadBabel();
+
+  // Each fragment gets a residue with its atoms and the bonds
+  // bondFragment gives it
+  OBMol mol;
+  mol.BeginModify();
+  for(unsigned int f=0; f<batch.fragments.size(); f++)
+    {
+      const BatchFragment& fragment = batch.fragments[f];
+      OBResidue* residue = mol.NewResidue();
+      residue->SetName(string(fragment.residue, sizeof(fragment.residue)));
+      residue->SetNum(fragment.resSeq);
+      residue->SetChain(fragment.chain);
+      for(unsigned int i=fragment.first; i<fragment.first+fragment.count; i++)
+        {
+          const BatchAtom& a = batch.atoms[i];
+          OBAtom* atom = mol.NewAtom();
+          atom->SetAtomicNum(atomicNumber(a));
+          atom->SetVector(a.x, a.y, a.z);
+          residue->AddAtom(atom);
+          residue->SetAtomID(atom, string(a.name, sizeof(a.name)));
+          residue->SetHetAtom(atom, a.het);
+        }
+      bondFragment(batch, fragment, mol);
+    }
+  mol.EndModify();
+  mol.PerceiveBondOrders();
+
+  // Here is where Babel adds hydrogens to the residues
+  // TO ADD: option to set pH
+  mol.AddHydrogens(false,true,PH_LEVEL);
+
+  // Babel appends the hydrogens after the atoms it was given
+  unsigned int numAtoms = batch.atoms.size();
+  for(unsigned int i=numAtoms+1; i<=mol.NumAtoms(); i++)
+    {
+      OBAtom* h = mol.GetAtom(i);
+      if( !h->IsHydrogen() )
+        {
+          continue;
+        }
+      int parent = -1;
+      FOR_NBORS_OF_ATOM(nbr, h)
+        {
+          if( nbr->GetIdx() <= numAtoms )
+            {
+              parent = nbr->GetIdx() - 1;
+            }
+        }
+      if( parent < 0 )
+        {
+          continue;
+        }
+      unsigned int f = batch.fragments.size() - 1;
+      while( batch.fragments[f].first > (unsigned int)parent )
+        {
+          f--;
+        }
+      AddedHydrogen a;
+      a.fragment = f;
+      a.parent   = parent - batch.fragments[f].first;
+      a.x        = h->GetX();
+      a.y        = h->GetY();
+      a.z        = h->GetZ();
+      added.push_back(a);
+    }
+}
+
+// Milliseconds since the epoch
+static long long nowMs()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// Waits until fd is ready for events.  deadline is in nowMs() time; a
+// negative one waits for as long as it takes.  Past the deadline fd is
+// still polled once, so a worker waited on after one that hung is not
+// taken for hung too
+static int waitFor(int fd, short events, long long deadline)
+{
+  if( deadline < 0 )
+    {
+      return IO_OK;
+    }
+  while( true )
+    {
+      long long left = max(deadline - nowMs(), 0LL);
+      struct pollfd pfd;
+      pfd.fd     = fd;
+      pfd.events = events;
+      int ready = poll(&pfd, 1, (int)min(left, 1000000LL));
+      if( ready < 0 && errno == EINTR )
+        {
+          continue;
+        }
+      return ready == 0 ? IO_TIMEOUT : IO_OK;
+    }
+}
+
+// Writes all of buffer before deadline (see waitFor), going on after
+// interrupts and partial writes.  A worker that is gone makes the
+// write fail with EPIPE rather than raise SIGPIPE (see BabelPool::start)
+static int writeAll(int fd, const void* buffer, size_t size, long long deadline)
+{
+  const char* p = (const char*)buffer;
+  while( size > 0 )
+    {
+      if( waitFor(fd, POLLOUT, deadline) == IO_TIMEOUT )
+        {
+          return IO_TIMEOUT;
+        }
+      ssize_t n = write(fd, p, size);
+      if( n < 0 && errno == EINTR )
+        {
+          continue;
+        }
+      if( n <= 0 )
+        {
+          return IO_CLOSED;
+        }
+      p    += n;
+      size -= n;
+    }
+  return IO_OK;
+}
+
+// Reads all of buffer before deadline (see waitFor)
+static int readAll(int fd, void* buffer, size_t size, long long deadline)
+{
+  char* p = (char*)buffer;
+  while( size > 0 )
+    {
+      if( waitFor(fd, POLLIN, deadline) == IO_TIMEOUT )
+        {
+          return IO_TIMEOUT;
+        }
+      ssize_t n = read(fd, p, size);
+      if( n < 0 && errno == EINTR )
+        {
+          continue;
+        }
+      if( n <= 0 )
+        {
+          return IO_CLOSED;
+        }
+      p    += n;
+      size -= n;
+    }
+  return IO_OK;
+}
+
+// Sends batch to a worker before deadline (see waitFor)
+static int sendBatch(int fd, const HydrogenBatch& batch, long long deadline)
+{
+  unsigned int header[4] = { BATCH_MAGIC,
+                             (unsigned int)batch.fragments.size(),
+                             (unsigned int)batch.atoms.size(),
+                             (unsigned int)batch.bonds.size() };
+  int status = writeAll(fd, header, sizeof(header), deadline);
+  if( status == IO_OK && !batch.fragments.empty() )
+    {
+      status = writeAll(fd, &batch.fragments[0], batch.fragments.size() * sizeof(BatchFragment), deadline);
+    }
+  if( status == IO_OK && !batch.atoms.empty() )
+    {
+      status = writeAll(fd, &batch.atoms[0], batch.atoms.size() * sizeof(BatchAtom), deadline);
+    }
+  if( status == IO_OK && !batch.bonds.empty() )
+    {
+      status = writeAll(fd, &batch.bonds[0], batch.bonds.size() * sizeof(unsigned int), deadline);
+    }
+  return status;
+}
+
+// What a worker does until the main process closes its pipe
+static void workerLoop(int request, int reply)
+{
+  HydrogenBatch         batch;
+  vector<AddedHydrogen> added;
+  unsigned int          header[4];
+  while( readAll(request, header, sizeof(header), -1) == IO_OK && header[0] == BATCH_MAGIC )
+    {
+      batch.fragments.resize(header[1]);
+      batch.atoms.resize(header[2]);
+      batch.bonds.resize(header[3]);
+      if( ( header[1] && readAll(request, &batch.fragments[0], header[1] * sizeof(BatchFragment), -1) != IO_OK ) ||
+          ( header[2] && readAll(request, &batch.atoms[0],     header[2] * sizeof(BatchAtom),     -1) != IO_OK ) ||
+          ( header[3] && readAll(request, &batch.bonds[0],     header[3] * sizeof(unsigned int),  -1) != IO_OK ) )
+        {
+          return;
+        }
+
+      bool loaded = babelLoadTime() >= 0;
+      protonateBatch(batch, added);
+
+      unsigned int answer[4] = { REPLY_MAGIC,
+                                 (unsigned int)added.size(),
+                                 !loaded && babelLoadTime() >= 0,
+                                 loaded ? 0 : (unsigned int)(max(babelLoadTime(), 0.0) * 1e6) };
+      if( writeAll(reply, answer, sizeof(answer), -1) != IO_OK ||
+          ( !added.empty() && writeAll(reply, &added[0], added.size() * sizeof(AddedHydrogen), -1) != IO_OK ) )
+        {
+          return;
+        }
+    }
+}
+
+BabelPool::BabelPool()
+{
+  restarts = 0;
+  loads    = 0;
+  loadTime = 0;
+  timeout  = BABEL_WORKER_TIMEOUT;
+}
+
+BabelPool::~BabelPool()
+{
+  stop();
+}
+
+bool BabelPool::start(unsigned int n, unsigned int timeout)
+{
+  stop();
+  this->timeout = timeout;
+
+  // A worker that died must not take the main process with it when
+  // its pipe is written to
+  signal(SIGPIPE, SIG_IGN);
+
+  workers.resize(n);
+  for(unsigned int i=0; i<n; i++)
+    {
+      if( !spawn(i) )
+        {
+          workers.resize(i);
+          stop();
+          return false;
+        }
+    }
+  return true;
+}
+
+void BabelPool::stop()
+{
+  // Closing the request pipe tells a worker to exit
+  for(unsigned int i=0; i<workers.size(); i++)
+    {
+      close(workers[i].request);
+      close(workers[i].reply);
+    }
+  for(unsigned int i=0; i<workers.size(); i++)
+    {
+      waitpid(workers[i].pid, NULL, 0);
+    }
+  workers.clear();
+}
+
+unsigned int BabelPool::size() const
+{
+  return workers.size();
+}
+
+bool BabelPool::spawn(unsigned int i)
+{
+  int request[2];
+  int reply[2];
+  if( pipe(request) != 0 )
+    {
+      return false;
+    }
+  if( pipe(reply) != 0 )
+    {
+      close(request[0]);
+      close(request[1]);
+      return false;
+    }
+
+  // Anything still buffered would be written out by both processes
+  cout.flush();
+  fflush(stdout);
+
+  pid_t pid = fork();
+  if( pid < 0 )
+    {
+      close(request[0]);
+      close(request[1]);
+      close(reply[0]);
+      close(reply[1]);
+      return false;
+    }
+  if( pid == 0 )
+    {
+      close(request[1]);
+      close(reply[0]);
+      for(unsigned int j=0; j<workers.size(); j++)
+        {
+          if( j != i )
+            {
+              close(workers[j].request);
+              close(workers[j].reply);
+            }
+        }
+      workerLoop(request[0], reply[1]);
+      _exit(0);
+    }
+
+  close(request[0]);
+  close(reply[1]);
+  workers[i].pid     = pid;
+  workers[i].request = request[1];
+  workers[i].reply   = reply[0];
+  return true;
+}
+
+void BabelPool::restart(unsigned int i, const char* why)
+{
+  cout << cyan << "WARNING" << reset << ": Babel worker " << workers[i].pid << " " << why
+       << "; starting another" << endl;
+  // One that already exited is only reaped, so its pid is not killed
+  // after it could have been given to another process
+  int status;
+  if( waitpid(workers[i].pid, &status, WNOHANG) != workers[i].pid )
+    {
+      kill(workers[i].pid, SIGKILL);
+      waitpid(workers[i].pid, NULL, 0);
+    }
+  close(workers[i].request);
+  close(workers[i].reply);
+  restarts++;
+  if( !spawn(i) )
+    {
+      cerr << red << "Error" << reset << ": could not start a Babel worker" << endl;
+      exit(1);
+    }
+}
+
+void BabelPool::run(const vector<HydrogenBatch>& batches,
+                    vector< vector<AddedHydrogen> >& added,
+                    vector<bool>& ok)
+{
+  added.assign(batches.size(), vector<AddedHydrogen>());
+  ok.assign(batches.size(), false);
+
+  // A round hands a batch to every worker and then collects the replies
+  for(unsigned int start=0; start<batches.size(); start+=workers.size())
+    {
+      unsigned int n = min((unsigned int)workers.size(), (unsigned int)(batches.size() - start));
+      long long deadline = timeout > 0 ? nowMs() + 1000LL * timeout : -1;
+      vector<bool> sent(n, false);
+      for(unsigned int k=0; k<n; k++)
+        {
+          // A worker that is already gone is only found out here, by
+          // the write failing.  The batch is not what killed it, so a
+          // new worker gets it once more
+          int status = sendBatch(workers[k].request, batches[start+k], deadline);
+          if( status != IO_OK )
+            {
+              restart(k, status == IO_TIMEOUT ? "did not take a batch in time" : "was gone before it got a batch");
+              status = sendBatch(workers[k].request, batches[start+k], deadline);
+            }
+          sent[k] = status == IO_OK;
+          if( !sent[k] )
+            {
+              cerr << red << "Error" << reset << ": could not send a batch of " << batches[start+k].fragments.size()
+                   << " residues to a Babel worker" << endl;
+              restart(k, "could not be sent a batch");
+            }
+        }
+
+      for(unsigned int k=0; k<n; k++)
+        {
+          if( !sent[k] )
+            {
+              continue;
+            }
+          unsigned int answer[4];
+          int status = readAll(workers[k].reply, answer, sizeof(answer), deadline);
+          if( status == IO_OK && answer[0] != REPLY_MAGIC )
+            {
+              status = IO_CLOSED;
+            }
+          if( status == IO_OK && answer[2] )
+            {
+              loads++;
+              loadTime += answer[3] * 1e-6;
+            }
+          if( status == IO_OK && answer[1] > 0 )
+            {
+              added[start+k].resize(answer[1]);
+              status = readAll(workers[k].reply, &added[start+k][0], answer[1] * sizeof(AddedHydrogen), deadline);
+            }
+          if( status == IO_OK )
+            {
+              ok[start+k] = true;
+              continue;
+            }
+          added[start+k].clear();
+          restart(k, status == IO_TIMEOUT ? "timed out" : "crashed");
+        }
+    }
+}
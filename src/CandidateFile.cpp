@@ -0,0 +1,335 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: CandidateFile.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Functions for writing and reading the file of candidate pairs
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "CandidateFile.hpp"
+#include "CoutColors.hpp"
+
+// Length of an ATOM/HETATM line, the way it is stored
+#define CANDIDATE_LINE 80
+
+// Numbers are written a byte at a time, least significant first, and
+// floats as the bits of their IEEE 754 single precision value, so that
+// the file does not depend on how the machine lays them out.  An atom
+// is its line followed by its coordinates, which are kept apart from
+// the line since an atom of a moved copy is not exactly where its line
+// says
+static void putByte(ostream& out, unsigned char value)
+{
+  out.put((char)value);
+}
+
+static void putWord(ostream& out, unsigned int value)
+{
+  for(int i=0; i<4; i++)
+    {
+      putByte(out, (value >> (8*i)) & 0xff);
+    }
+}
+
+static void putFloat(ostream& out, float value)
+{
+  unsigned int bits;
+  memcpy(&bits, &value, sizeof(bits));
+  putWord(out, bits);
+}
+
+static void putCoordinates(ostream& out, const Coordinates& c)
+{
+  putFloat(out, c.x);
+  putFloat(out, c.y);
+  putFloat(out, c.z);
+}
+
+static bool getByte(istream& in, unsigned char& value)
+{
+  int c = in.get();
+  value = (unsigned char)c;
+  return c != EOF;
+}
+
+static bool getWord(istream& in, unsigned int& value)
+{
+  value = 0;
+  for(int i=0; i<4; i++)
+    {
+      unsigned char b;
+      if( !getByte(in, b) )
+        {
+          return false;
+        }
+      value |= (unsigned int)b << (8*i);
+    }
+  return true;
+}
+
+static bool getFloat(istream& in, float& value)
+{
+  unsigned int bits;
+  if( !getWord(in, bits) )
+    {
+      return false;
+    }
+  memcpy(&value, &bits, sizeof(value));
+  return true;
+}
+
+static bool getCoordinates(istream& in, Coordinates& c)
+{
+  float x, y, z;
+  if( !getFloat(in, x) || !getFloat(in, y) || !getFloat(in, z) )
+    {
+      return false;
+    }
+  c = Coordinates(x, y, z);
+  return true;
+}
+
+// Writes the atoms of r that are given to Babel
+static void putResidue(ostream& out, const AminoAcid& r, const vector<Atom*>& given)
+{
+  char name[4] = { 0, 0, 0, 0 };
+  strncpy(name, r.residue.c_str(), 3);
+  out.write(name, sizeof(name));
+  putWord(out, given.size());
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      char line[CANDIDATE_LINE];
+      memset(line, ' ', CANDIDATE_LINE);
+      memcpy(line, given[i]->line.c_str(), min((size_t)CANDIDATE_LINE, given[i]->line.size()));
+      out.write(line, CANDIDATE_LINE);
+      putCoordinates(out, given[i]->coord);
+    }
+}
+
+CandidateWriter::CandidateWriter()
+{
+  opened     = false;
+  structures = 0;
+  pairs      = 0;
+  lastModel  = 0;
+}
+
+bool CandidateWriter::open(const char* filename)
+{
+  out.open(filename);
+  if( !out.rdbuf()->is_open() )
+    {
+      return false;
+    }
+  out.write(CANDIDATE_MAGIC, strlen(CANDIDATE_MAGIC));
+  putWord(out, CANDIDATE_VERSION);
+  opened     = true;
+  structures = 0;
+  pairs      = 0;
+  lastFile.clear();
+  return out.good();
+}
+
+bool CandidateWriter::isOpen() const
+{
+  return opened;
+}
+
+void CandidateWriter::write(const PairCandidate& pair, float threshold, const PDB& PDBfile)
+{
+  string file(PDBfile.filename ? PDBfile.filename : "");
+  if( structures == 0 || file != lastFile || PDBfile.model_number != lastModel )
+    {
+      putByte(out, CANDIDATE_STRUCTURE);
+      putWord(out, file.size());
+      out.write(file.c_str(), file.size());
+      putFloat(out, PDBfile.resolution);
+      putWord(out, (unsigned int)PDBfile.model_number);
+      lastFile  = file;
+      lastModel = PDBfile.model_number;
+      structures++;
+    }
+
+  putByte(out, CANDIDATE_PAIR);
+  putByte(out, pair.code1);
+  putByte(out, pair.code2);
+  putFloat(out, threshold);
+  putFloat(out, pair.closestDist);
+  putFloat(out, pair.angle);
+  putFloat(out, pair.angle1);
+  putFloat(out, pair.angleP);
+  putCoordinates(out, pair.center1);
+  putCoordinates(out, pair.center2);
+  putResidue(out, *pair.aa1, pair.given1);
+  putResidue(out, *pair.aa2, pair.given2);
+  pairs++;
+}
+
+bool CandidateWriter::close()
+{
+  if( !opened )
+    {
+      return true;
+    }
+  putByte(out, CANDIDATE_END);
+  bool good = out.good();
+  out.close();
+  opened = false;
+  return good;
+}
+
+CandidateReader::CandidateReader()
+{
+  version    = 0;
+  fresh      = false;
+  resolution = 0;
+  model      = 0;
+  threshold  = 0;
+}
+
+bool CandidateReader::open(const char* filename)
+{
+  in.open(filename);
+  if( !in.rdbuf()->is_open() )
+    {
+      return false;
+    }
+  char magic[sizeof(CANDIDATE_MAGIC)] = "";
+  version = 0;
+  in.read(magic, strlen(CANDIDATE_MAGIC));
+  return in.gcount() == (streamsize)strlen(CANDIDATE_MAGIC) &&
+    strncmp(magic, CANDIDATE_MAGIC, strlen(CANDIDATE_MAGIC)) == 0 &&
+    getWord(in, version) && version == CANDIDATE_VERSION;
+}
+
+bool CandidateReader::readResidue(vector<Atom>& atoms, AminoAcid& r)
+{
+  char name[4];
+  unsigned int count;
+  in.read(name, sizeof(name));
+  if( in.gcount() != (streamsize)sizeof(name) || !getWord(in, count) || count == 0 )
+    {
+      return false;
+    }
+
+  // The atoms are all read in before r points to them
+  atoms.clear();
+  for(unsigned int i=0; i<count; i++)
+    {
+      char line[CANDIDATE_LINE];
+      Coordinates coord;
+      in.read(line, CANDIDATE_LINE);
+      if( in.gcount() != CANDIDATE_LINE || !getCoordinates(in, coord) )
+        {
+          return false;
+        }
+      atoms.push_back(Atom(string(line, CANDIDATE_LINE), i+1));
+      atoms.back().coord      = coord;
+      atoms.back().skip       = false;
+      atoms.back().altLocMask = ALTLOC_MASK_ALL;
+    }
+
+  r = AminoAcid();
+  r.residue = string(name, strnlen(name, sizeof(name)));
+  for(unsigned int i=0; i<atoms.size(); i++)
+    {
+      r.atom.push_back(&atoms[i]);
+    }
+  return true;
+}
+
+int CandidateReader::next()
+{
+  unsigned char kind;
+  if( !getByte(in, kind) )
+    {
+      return CANDIDATE_ERROR;
+    }
+
+  if( kind == CANDIDATE_STRUCTURE )
+    {
+      unsigned int length;
+      if( !getWord(in, length) )
+        {
+          return CANDIDATE_ERROR;
+        }
+      filename.resize(length);
+      if( length > 0 )
+        {
+          in.read(&filename[0], length);
+        }
+      unsigned int number;
+      if( in.gcount() != (streamsize)length || !getFloat(in, resolution) || !getWord(in, number) )
+        {
+          return CANDIDATE_ERROR;
+        }
+      model = (int)number;
+      fresh = true;
+      return CANDIDATE_STRUCTURE;
+    }
+
+  if( kind == CANDIDATE_PAIR )
+    {
+      if( fresh )
+        {
+          atoms.clear();
+          residues.clear();
+          fresh = false;
+        }
+      atoms.resize(atoms.size() + 2);
+      residues.resize(residues.size() + 2);
+      AminoAcid& aa1 = residues[residues.size() - 2];
+      AminoAcid& aa2 = residues.back();
+
+      unsigned char code1, code2;
+      if( !getByte(in, code1) || !getByte(in, code2) ||
+          !getFloat(in, threshold) || !getFloat(in, pair.closestDist) ||
+          !getFloat(in, pair.angle) || !getFloat(in, pair.angle1) || !getFloat(in, pair.angleP) ||
+          !getCoordinates(in, pair.center1) || !getCoordinates(in, pair.center2) ||
+          !readResidue(atoms[atoms.size() - 2], aa1) || !readResidue(atoms.back(), aa2) )
+        {
+          return CANDIDATE_ERROR;
+        }
+      pair.aa1   = &aa1;
+      pair.aa2   = &aa2;
+      pair.given1.assign(aa1.atom.begin(), aa1.atom.end());
+      pair.given2.assign(aa2.atom.begin(), aa2.atom.end());
+      pair.code1 = code1;
+      pair.code2 = code2;
+      return CANDIDATE_PAIR;
+    }
+
+  return kind == CANDIDATE_END ? CANDIDATE_END : CANDIDATE_ERROR;
+}
@@ -0,0 +1,409 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Distance.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the batched closest center search
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cfloat>
+#include <cmath>
+#include "Distance.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+// Every kernel does (dx*dx + dy*dy) + dz*dz in single precision without
+// fused multiply-adds, exactly like Coordinates::distance, so the
+// winner's distance comes out the same as the scalar code's
+typedef void (*SquaredDistanceKernel)(const float* ax, const float* ay, const float* az,
+                                      const float* bx, const float* by, const float* bz,
+                                      unsigned int n, float* d2);
+
+static void squaredDistancesScalar(const float* ax, const float* ay, const float* az,
+                                   const float* bx, const float* by, const float* bz,
+                                   unsigned int n, float* d2)
+{
+  for(unsigned int k=0; k<n; k++)
+    {
+      float dx = ax[k] - bx[k];
+      float dy = ay[k] - by[k];
+      float dz = az[k] - bz[k];
+      d2[k] = (dx*dx + dy*dy) + dz*dz;
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+// SSE is always there on x86-64
+static void squaredDistancesSSE(const float* ax, const float* ay, const float* az,
+                                const float* bx, const float* by, const float* bz,
+                                unsigned int n, float* d2)
+{
+  unsigned int k = 0;
+  for(; k+4 <= n; k+=4)
+    {
+      __m128 dx = _mm_sub_ps(_mm_loadu_ps(ax+k), _mm_loadu_ps(bx+k));
+      __m128 dy = _mm_sub_ps(_mm_loadu_ps(ay+k), _mm_loadu_ps(by+k));
+      __m128 dz = _mm_sub_ps(_mm_loadu_ps(az+k), _mm_loadu_ps(bz+k));
+      __m128 s  = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+      _mm_storeu_ps(d2+k, _mm_add_ps(s, _mm_mul_ps(dz, dz)));
+    }
+  squaredDistancesScalar(ax+k, ay+k, az+k, bx+k, by+k, bz+k, n-k, d2+k);
+}
+
+__attribute__((target("avx2")))
+static void squaredDistancesAVX2(const float* ax, const float* ay, const float* az,
+                                 const float* bx, const float* by, const float* bz,
+                                 unsigned int n, float* d2)
+{
+  unsigned int k = 0;
+  for(; k+8 <= n; k+=8)
+    {
+      __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(ax+k), _mm256_loadu_ps(bx+k));
+      __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ay+k), _mm256_loadu_ps(by+k));
+      __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(az+k), _mm256_loadu_ps(bz+k));
+      __m256 s  = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+      _mm256_storeu_ps(d2+k, _mm256_add_ps(s, _mm256_mul_ps(dz, dz)));
+    }
+  squaredDistancesSSE(ax+k, ay+k, az+k, bx+k, by+k, bz+k, n-k, d2+k);
+}
+#endif
+
+// Picks the kernel the first time it is needed
+static SquaredDistanceKernel pickKernel(const char** name)
+{
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx2") )
+    {
+      *name = "avx2";
+      return squaredDistancesAVX2;
+    }
+  *name = "sse";
+  return squaredDistancesSSE;
+#else
+  *name = "scalar";
+  return squaredDistancesScalar;
+#endif
+}
+
+static const char* kernelName = NULL;
+static SquaredDistanceKernel kernel = pickKernel(&kernelName);
+
+const char* distanceKernelName()
+{
+  return kernelName;
+}
+
+static bool fixedPoint = false;
+
+void setFixedPointDistances(bool on)
+{
+  fixedPoint = on;
+}
+
+bool fixedPointDistances()
+{
+  return fixedPoint;
+}
+
+float distanceReach(float threshold)
+{
+  return fixedPoint ? threshold + FIXED_POINT_SLACK : threshold;
+}
+
+// Squared distances in milli-Angstroms squared.  The differences fit
+// in 32 bits for anything a PDB file can hold, their squares do not
+static void squaredDistancesFixed(const FixedCoordinates* a, const FixedCoordinates* b,
+                                  unsigned int n, long long* d2)
+{
+  for(unsigned int k=0; k<n; k++)
+    {
+      d2[k] = a[k].squaredDistance(b[k]);
+    }
+}
+
+void addClosestCombinations(AminoAcid& a, AminoAcid& b, float threshold)
+{
+  if( a.combinations.empty() && b.combinations.empty() )
+    {
+      return;
+    }
+  float limit = distanceReach(threshold);
+  a.addClosestCombinations(b.center, limit);
+  b.addClosestCombinations(a.center, limit);
+}
+
+void addClosestCombinations(AminoAcid& a, AminoAcid& b, const Transform& op, float threshold)
+{
+  if( a.combinations.empty() && b.combinations.empty() )
+    {
+      return;
+    }
+  float limit = distanceReach(threshold);
+  vector<Coordinates> targets;
+  if( !a.combinations.empty() )
+    {
+      for(unsigned int j=0; j<b.center.size(); j++)
+        {
+          targets.push_back(op.apply(b.center[j]));
+          targets.back().skip = b.center[j].skip;
+        }
+      a.addClosestCombinations(targets, limit);
+    }
+  if( !b.combinations.empty() )
+    {
+      Transform back = op.inverse();
+      targets.clear();
+      for(unsigned int i=0; i<a.center.size(); i++)
+        {
+          targets.push_back(back.apply(a.center[i]));
+          targets.back().skip = a.center[i].skip;
+        }
+      b.addClosestCombinations(targets, limit);
+    }
+}
+
+DistanceBatch::DistanceBatch()
+{
+  clear();
+}
+
+void DistanceBatch::clear()
+{
+  ax.clear(); ay.clear(); az.clear();
+  bx.clear(); by.clear(); bz.clear();
+  fa.clear(); fb.clear();
+  ia.clear(); ib.clear();
+  start.clear();
+  start.push_back(0);
+  closest.clear();
+  index1.clear();
+  index2.clear();
+}
+
+unsigned int DistanceBatch::size() const
+{
+  return start.size() - 1;
+}
+
+void DistanceBatch::push(const Coordinates& a, const Coordinates& b, unsigned int i, unsigned int j)
+{
+  if( fixedPoint )
+    {
+      fa.push_back(FixedCoordinates(a));
+      fb.push_back(FixedCoordinates(b));
+    }
+  else
+    {
+      ax.push_back(a.x); ay.push_back(a.y); az.push_back(a.z);
+      bx.push_back(b.x); by.push_back(b.y); bz.push_back(b.z);
+    }
+  ia.push_back(i);
+  ib.push_back(j);
+}
+
+unsigned int DistanceBatch::add(AminoAcid& a, AminoAcid& b)
+{
+  for(unsigned int i=0; i<a.center.size(); i++)
+    {
+      if( a.center[i].skip ) continue;
+      for(unsigned int j=0; j<b.center.size(); j++)
+        {
+          if( b.center[j].skip ) continue;
+          push(a.center[i], b.center[j], i, j);
+        }
+    }
+  start.push_back(ia.size());
+  return size() - 1;
+}
+
+// The moved centers of b are the outer loop, as in the scalar code
+unsigned int DistanceBatch::add(AminoAcid& a, AminoAcid& b, const Transform& op)
+{
+  for(unsigned int j=0; j<b.center.size(); j++)
+    {
+      if( b.center[j].skip ) continue;
+      Coordinates moved = op.apply(b.center[j]);
+      for(unsigned int i=0; i<a.center.size(); i++)
+        {
+          if( a.center[i].skip ) continue;
+          push(a.center[i], moved, i, j);
+        }
+    }
+  start.push_back(ia.size());
+  return size() - 1;
+}
+
+void DistanceBatch::run(float threshold)
+{
+  if( fixedPoint )
+    {
+      runFixed(threshold);
+      return;
+    }
+
+  unsigned int n = ia.size();
+  d2.resize(n);
+  if( n )
+    {
+      kernel(&ax[0], &ay[0], &az[0], &bx[0], &by[0], &bz[0], n, &d2[0]);
+    }
+
+  // Anything at or above the threshold squared (with a little room for
+  // rounding) can't win.  The winner gets the real check below
+  float limit2 = threshold * threshold * (1 + 4*FLT_EPSILON);
+
+  unsigned int pairs = size();
+  closest.assign(pairs, FLT_MAX);
+  index1.assign(pairs, 0);
+  index2.assign(pairs, 0);
+  for(unsigned int p=0; p<pairs; p++)
+    {
+      float best = FLT_MAX;
+      unsigned int winner = 0;
+      for(unsigned int k=start[p]; k<start[p+1]; k++)
+        {
+          if( d2[k] < best && d2[k] < limit2 )
+            {
+              best = d2[k];
+              winner = k;
+            }
+        }
+      if( best == FLT_MAX )
+        {
+          continue;
+        }
+      float dist = sqrt(best);
+      if( dist < threshold )
+        {
+          closest[p] = dist;
+          index1[p]  = ia[winner];
+          index2[p]  = ib[winner];
+        }
+    }
+}
+
+// The same search in fixed point.  The threshold test of the rounded
+// centers is exact, and the
+// distance that is handed back is nudged under the threshold in the rare
+// case where the square root rounds up onto it, so the float comparisons
+// made with it later agree with the integer one
+void DistanceBatch::runFixed(float threshold)
+{
+  unsigned int n = ia.size();
+  vector<long long> d2(n);
+  if( n )
+    {
+      squaredDistancesFixed(&fa[0], &fb[0], n, &d2[0]);
+    }
+
+  long long limit = lrint(threshold * (double)FIXED_POINT_SCALE);
+  long long limit2 = limit * limit;
+
+  unsigned int pairs = size();
+  closest.assign(pairs, FLT_MAX);
+  index1.assign(pairs, 0);
+  index2.assign(pairs, 0);
+  for(unsigned int p=0; p<pairs; p++)
+    {
+      long long best = limit2;
+      unsigned int winner = 0;
+      for(unsigned int k=start[p]; k<start[p+1]; k++)
+        {
+          if( d2[k] < best )
+            {
+              best = d2[k];
+              winner = k;
+            }
+        }
+      if( best == limit2 )
+        {
+          continue;
+        }
+      float dist = sqrt((double)best) / FIXED_POINT_SCALE;
+      closest[p] = dist < threshold ? dist : nextafterf(threshold, 0);
+      index1[p]  = ia[winner];
+      index2[p]  = ib[winner];
+    }
+}
+
+// Finds the closest distance among all of the centers
+// associated with each amino acid
+double findClosestDistance(AminoAcid& aa1,
+                           AminoAcid& aa2,
+                           float threshold,
+                           unsigned int* closest_index1,
+                           unsigned int* closest_index2)
+{
+  // Go through all combination of distances looking
+  // for the closet pair
+  addClosestCombinations(aa1, aa2, threshold);
+  DistanceBatch batch;
+  batch.clear();
+  batch.add(aa1, aa2);
+  batch.run(threshold);
+
+  // flag it if is the closest and within the threshold
+  if( batch.closest[0] == FLT_MAX )
+    {
+      return FLT_MAX;
+    }
+  *closest_index1 = batch.index1[0];
+  *closest_index2 = batch.index2[0];
+  return batch.closest[0];
+}
+
+// Same as above, but the centers of aa2 are moved by op on the fly
+double findClosestDistance(AminoAcid& aa1,
+                           AminoAcid& aa2,
+                           const Transform& op,
+                           float threshold,
+                           unsigned int* closest_index1,
+                           unsigned int* closest_index2)
+{
+  addClosestCombinations(aa1, aa2, op, threshold);
+  DistanceBatch batch;
+  batch.clear();
+  batch.add(aa1, aa2, op);
+  batch.run(threshold);
+
+  if( batch.closest[0] == FLT_MAX )
+    {
+      return FLT_MAX;
+    }
+  *closest_index1 = batch.index1[0];
+  *closest_index2 = batch.index2[0];
+  return batch.closest[0];
+}
@@ -0,0 +1,137 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: FixedPoint.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the FixedCoordinates class and the column parser
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cmath>
+#include "FixedPoint.hpp"
+
+FixedCoordinates::FixedCoordinates()
+{
+  x = y = z = 0;
+}
+
+FixedCoordinates::FixedCoordinates(const Coordinates& point)
+{
+  x = (int)lrint(point.x * (double)FIXED_POINT_SCALE);
+  y = (int)lrint(point.y * (double)FIXED_POINT_SCALE);
+  z = (int)lrint(point.z * (double)FIXED_POINT_SCALE);
+}
+
+Coordinates FixedCoordinates::toCoordinates() const
+{
+  return Coordinates(fixedPointToFloat(x, false),
+                     fixedPointToFloat(y, false),
+                     fixedPointToFloat(z, false));
+}
+
+long long FixedCoordinates::squaredDistance(const FixedCoordinates& point) const
+{
+  long long dx = (long long)x - point.x;
+  long long dy = (long long)y - point.y;
+  long long dz = (long long)z - point.z;
+  return dx*dx + dy*dy + dz*dz;
+}
+
+bool parseFixedPoint(const string& line,
+                     unsigned int start,
+                     unsigned int width,
+                     int* value,
+                     bool* negative)
+{
+  if( line.length() < start + width )
+    {
+      return false;
+    }
+  const char* c   = line.c_str() + start;
+  const char* end = c + width;
+
+  // Leading blanks, then an optional sign
+  while( c < end && *c == ' ' ) c++;
+  *negative = false;
+  if( c < end && (*c == '-' || *c == '+') )
+    {
+      *negative = *c == '-';
+      c++;
+    }
+
+  int whole = 0;
+  int digits = 0;
+  while( c < end && *c >= '0' && *c <= '9' )
+    {
+      whole = whole * 10 + (*c - '0');
+      c++;
+      digits++;
+    }
+  int fraction = 0;
+  int decimals = 0;
+  if( c < end && *c == '.' )
+    {
+      c++;
+      while( c < end && *c >= '0' && *c <= '9' && decimals < 3 )
+        {
+          fraction = fraction * 10 + (*c - '0');
+          c++;
+          decimals++;
+        }
+    }
+  // Nothing else is allowed after the number, and anything with more
+  // than three decimals or more than 4 whole digits isn't ours to read.
+  // Past 9999.999 the thousandths no longer fit in the 24 bits of a
+  // float, so fixedPointToFloat would round twice
+  if( c != end || digits + decimals == 0 || digits > 4 )
+    {
+      return false;
+    }
+  for(; decimals < 3; decimals++)
+    {
+      fraction *= 10;
+    }
+  *value = whole * FIXED_POINT_SCALE + fraction;
+  if( *negative )
+    {
+      *value = -*value;
+    }
+  return true;
+}
+
+// Below 2^24 the value converts to float exactly, so the one rounding is
+// that of the division, which gives the nearest float to value/1000
+// just like reading the text does
+float fixedPointToFloat(int value, bool negative)
+{
+  float f = (float)value / FIXED_POINT_SCALE;
+  return ( negative && value == 0 ) ? -0.0f : f;
+}
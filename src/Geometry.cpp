@@ -286,3 +286,59 @@ float calculateAngleBetweenPlanes( Coordinates& planeP,
     }
 
 }
+
+// Calculate the angle between a precalculated plane and a line
+float angleBetweenPlaneAndLine(const Plane& plane,
+                               Coordinates& point1,
+                               Coordinates& point2)
+{
+  Coordinates line = point2 - point1;
+  Coordinates normal = plane.normal;
+  float cosValue = dotProduct(normal, line) / line.norm();
+
+  // A unit normal can still overshoot 1 by a rounding error
+  if( cosValue < -1.0 || cosValue > 1.0 )
+    {
+      if( fabs(cosValue) > 1.0 + 1e-5 )
+        {
+          cerr << red << "Error" << reset << ":Error: Cosine of angle, " << cosValue << ", lies outside of -1 and 1" << endl;
+          return 1000;
+        }
+      cosValue = cosValue < 0 ? -1.0 : 1.0;
+    }
+  return abs ( 90 - ( acos(cosValue) * 180 / 3.14159  ) );
+}
+
+// Drops the point straight down onto the plane
+void planeProjectCoordinate(const Plane& plane,
+                            Coordinates& point,
+                            Coordinates* result)
+{
+  *result = point - plane.normal * plane.distance(point);
+}
+
+// Calculate the angle between two precalculated planes
+float calculateAngleBetweenPlanes(const Plane& plane1,
+                                  const Plane& plane2)
+{
+  Coordinates normal1 = plane1.normal;
+  Coordinates normal2 = plane2.normal;
+  float cosValue = dotProduct(normal1, normal2);
+
+  if( cosValue < -1 || cosValue > 1 )
+    {
+      if( fabs(cosValue) > 1.0 + 1e-5 )
+        {
+          cerr << red << "Error" << reset << ":Error: Cosine of angle, " << cosValue << ", lies outside of -1 and 1" << endl;
+          return 1000;
+        }
+      cosValue = cosValue < 0 ? -1.0 : 1.0;
+    }
+
+  float angle = acos(cosValue) * 180 / 3.14159;
+  if(angle > 90)
+    {
+      angle = 180.0 - angle;
+    }
+  return angle;
+}
@@ -0,0 +1,177 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: HydrogenCache.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: The hydrogens of every residue protonated in a model
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#include <cstdio>
+#include <algorithm>
+#include "HydrogenCache.hpp"
+
+ResidueKey::ResidueKey(const string& residue, const vector<Atom*>& given)
+{
+  this->residue = residue;
+  coords.reserve(3 * given.size());
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      coords.push_back(given[i]->coord.x);
+      coords.push_back(given[i]->coord.y);
+      coords.push_back(given[i]->coord.z);
+    }
+}
+
+bool ResidueKey::operator<(const ResidueKey& rhs) const
+{
+  if( residue != rhs.residue )
+    {
+      return residue < rhs.residue;
+    }
+  return coords < rhs.coords;
+}
+
+HydrogenCache::HydrogenCache()
+{
+  engine    = HYDROGENS_BABEL;
+  pool      = NULL;
+  hits      = 0;
+  misses    = 0;
+  avoided   = 0;
+  preloaded = 0;
+  compared  = 0;
+  disagreed = 0;
+  worst     = 0;
+}
+
+ProtonatedResidue* HydrogenCache::find(const ResidueKey& key)
+{
+  map<ResidueKey, ProtonatedResidue>::iterator it = entries.find(key);
+  if( it == entries.end() )
+    {
+      misses++;
+      return NULL;
+    }
+  hits++;
+  return &it->second;
+}
+
+bool HydrogenCache::contains(const ResidueKey& key) const
+{
+  return entries.count(key) != 0;
+}
+
+ProtonatedResidue& HydrogenCache::insert(const ResidueKey& key)
+{
+  ProtonatedResidue& p = entries[key];
+  p.hydrogens.clear();
+  p.bondedTo.clear();
+  p.corrected = false;
+  p.failed    = false;
+  return p;
+}
+
+void HydrogenCache::erase(const ResidueKey& key)
+{
+  entries.erase(key);
+}
+
+void HydrogenCache::clear()
+{
+  entries.clear();
+  hits      = 0;
+  misses    = 0;
+  avoided   = 0;
+  preloaded = 0;
+  compared  = 0;
+  disagreed = 0;
+  worst     = 0;
+}
+
+void HydrogenCache::tally(const HydrogenCache& other)
+{
+  hits      += other.hits;
+  misses    += other.misses;
+  avoided   += other.avoided;
+  preloaded += other.preloaded;
+  compared  += other.compared;
+  disagreed += other.disagreed;
+  worst      = max(worst, other.worst);
+}
+
+Atom makeHydrogen(const Atom& parent, int serial, const Coordinates& h)
+{
+  char buffer[96];
+  sprintf(buffer, "%-6.6s%5d  H  %-11.11s   %8.3f%8.3f%8.3f  1.00  0.00           H  ",
+          parent.line.substr(0,6).c_str(),
+          serial,
+          parent.line.substr(16,11).c_str(),
+          h.x, h.y, h.z);
+  return Atom(string(buffer), serial);
+}
+
+bool removeExcessHydrogens(const string& residue,
+                           const vector<Atom*>& given,
+                           ProtonatedResidue& p)
+{
+  p.corrected = false;
+  if( !(residue == "GLU" || residue == "ASP") || p.hydrogens.size() < 2 )
+    return false;
+
+  int carbon = -1;
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      if( given[i]->name == " CG " || given[i]->name == " CD " )
+        {
+          carbon = i;
+        }
+    }
+
+  Coordinates avg(0,0,0);
+  for(unsigned int i=0; i<p.hydrogens.size(); i++)
+    {
+      if( p.bondedTo[i] == carbon )
+        {
+          avg += p.hydrogens[i].coord;
+        }
+    }
+  avg /= 2;
+
+  Atom lastHydrogen = p.hydrogens.back();
+  lastHydrogen.setCoordinates(avg);
+  p.hydrogens.assign(1, lastHydrogen);
+  p.bondedTo.assign(1, carbon);
+  p.corrected = true;
+  return true;
+}
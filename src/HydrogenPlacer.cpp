@@ -0,0 +1,212 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: HydrogenPlacer.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Idealised hydrogen placement for the supported residues
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+#include "HydrogenPlacer.hpp"
+#include "ResidueTable.hpp"
+#include "Utils.hpp"
+
+// Element of an atom from its name, as the element column is not
+// always filled in
+static char elementOf(const Atom* a)
+{
+  return a->name.size() > 1 ? a->name[1] : ' ';
+}
+
+// Unit vector from a to b
+static Coordinates unitVector(const Coordinates& a, const Coordinates& b)
+{
+  Coordinates v = b - a;
+  float n = v.norm();
+  return n > 0 ? v / n : v;
+}
+
+static float dot(const Coordinates& a, const Coordinates& b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+bool placeHydrogens(const string& residue, const vector<Atom*>& given, ProtonatedResidue& p)
+{
+  const ResidueEntry* e = findResidueEntry(residue);
+  if( !e )
+    {
+      return false;
+    }
+  const ResidueDescriptor* d = e->descriptor;
+
+  // The atoms given to Babel, and the last one filling each slot like
+  // in AminoAcid::tableBonds
+  Atom* slot[MAX_RESIDUE_SLOTS];
+  int   index[MAX_RESIDUE_SLOTS];
+  for(unsigned int k=0; k<MAX_RESIDUE_SLOTS; k++)
+    {
+      slot[k] = NULL;
+    }
+  p.hydrogens.clear();
+  p.bondedTo.clear();
+  p.corrected = false;
+  p.failed    = false;
+  int serial = 0;
+  for(unsigned int i=0; i<given.size(); i++)
+    {
+      serial = max(serial, given[i]->serialNumber);
+      int k = findSlot(d, atomCode(given[i]->name));
+      if( k >= 0 )
+        {
+          slot[k]  = given[i];
+          index[k] = i;
+        }
+    }
+
+  // The bonds between the slots, both ways, from the CONECT lines
+  vector<int> bonded[MAX_RESIDUE_SLOTS];
+  for(unsigned int l=0; l<d->conectLines; l++)
+    {
+      int a = d->conect[l][0];
+      for(unsigned int j=1; j<MAX_BONDED+2 && d->conect[l][j] >= 0; j++)
+        {
+          int b = d->conect[l][j];
+          if( find(bonded[a].begin(), bonded[a].end(), b) == bonded[a].end() ) bonded[a].push_back(b);
+          if( find(bonded[b].begin(), bonded[b].end(), a) == bonded[b].end() ) bonded[b].push_back(a);
+        }
+    }
+
+  // The oxygen closest to the phosphorus is the P=O one
+  int doubleBonded = -1;
+  float closest = FLT_MAX;
+  for(unsigned int k=0; k<d->slots; k++)
+    {
+      if( slot[k] && elementOf(slot[k]) == 'O' && bonded[k].size() == 1 &&
+          slot[bonded[k][0]] && elementOf(slot[bonded[k][0]]) == 'P' )
+        {
+          float dist = slot[k]->coord.distance(slot[bonded[k][0]]->coord);
+          if( dist < closest )
+            {
+              closest = dist;
+              doubleBonded = k;
+            }
+        }
+    }
+
+  for(unsigned int k=0; k<d->slots; k++)
+    {
+      if( !slot[k] )
+        {
+          continue;
+        }
+      Coordinates& a = slot[k]->coord;
+      char element = elementOf(slot[k]);
+      Coordinates h;
+      bool place = false;
+
+      if( (element == 'C' || element == 'N') && bonded[k].size() == 2 &&
+          slot[bonded[k][0]] && slot[bonded[k][1]] )
+        {
+          // sp2: in the plane of the neighbours, away from both
+          Coordinates away = (unitVector(a, slot[bonded[k][0]]->coord) +
+                              unitVector(a, slot[bonded[k][1]]->coord)) * -1.0f;
+          float n = away.norm();
+          if( n > 1e-3 )
+            {
+              float length = element == 'N' ? NH_BOND_LENGTH : CH_BOND_LENGTH;
+              h = a + away * (length / n);
+              place = true;
+            }
+        }
+      else if( element == 'O' && (int)k != doubleBonded && doubleBonded >= 0 &&
+               bonded[k].size() == 1 && slot[bonded[k][0]] && elementOf(slot[bonded[k][0]]) == 'P' )
+        {
+          // P-O-H at POH_ANGLE, anti to the P=O oxygen
+          Coordinates& phosphorus = slot[bonded[k][0]]->coord;
+          Coordinates  b = unitVector(phosphorus, a);
+          Coordinates  ref = slot[doubleBonded]->coord - phosphorus;
+          Coordinates  perp = ref - b * dot(ref, b);
+          float n = perp.norm();
+          if( n > 1e-3 )
+            {
+              float bend = (180.0 - POH_ANGLE) * M_PI / 180.0;
+              Coordinates dir = b * (float)cos(bend) - perp * (float)(sin(bend) / n);
+              h = a + dir * OH_BOND_LENGTH;
+              place = true;
+            }
+        }
+
+      if( place )
+        {
+          serial++;
+          p.hydrogens.push_back(makeHydrogen(*slot[k], serial, h));
+          p.bondedTo.push_back(index[k]);
+        }
+    }
+  return true;
+}
+
+float compareHydrogens(const ProtonatedResidue& a, const ProtonatedResidue& b)
+{
+  vector<Coordinates> ha, hb;
+  for(unsigned int i=0; i<a.hydrogens.size(); i++)
+    {
+      ha.push_back(a.hydrogens[i].coord);
+    }
+  for(unsigned int i=0; i<b.hydrogens.size(); i++)
+    {
+      hb.push_back(b.hydrogens[i].coord);
+    }
+  if( ha.size() != hb.size() )
+    {
+      return -1;
+    }
+
+  float worst = 0;
+  for(unsigned int i=0; i<ha.size(); i++)
+    {
+      float nearest = FLT_MAX;
+      for(unsigned int j=0; j<hb.size(); j++)
+        {
+          nearest = min(nearest, ha[i].distance(hb[j]));
+        }
+      worst = max(worst, nearest);
+    }
+  return worst;
+}
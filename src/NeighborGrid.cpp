@@ -0,0 +1,158 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: NeighborGrid.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implements the cell grid declared in NeighborGrid.hpp
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "NeighborGrid.hpp"
+
+NeighborGrid::NeighborGrid()
+{
+  cell = 1.0;
+  dims[0] = dims[1] = dims[2] = 0;
+  cellStart.clear();
+  cellItems.clear();
+}
+
+bool NeighborGrid::empty() const
+{
+  return cellItems.empty();
+}
+
+int NeighborGrid::cellIndex(int i, int j, int k) const
+{
+  return (i * dims[1] + j) * dims[2] + k;
+}
+
+void NeighborGrid::build(const vector<Coordinates>& points, float cellSize)
+{
+  cellStart.clear();
+  cellItems.clear();
+  dims[0] = dims[1] = dims[2] = 0;
+  if( points.empty() )
+    {
+      return;
+    }
+
+  // Find the box that holds all of the points
+  lower = points[0];
+  upper = points[0];
+  for(unsigned int i=1; i<points.size(); i++)
+    {
+      lower.x = fmin(lower.x, points[i].x);
+      lower.y = fmin(lower.y, points[i].y);
+      lower.z = fmin(lower.z, points[i].z);
+      upper.x = fmax(upper.x, points[i].x);
+      upper.y = fmax(upper.y, points[i].y);
+      upper.z = fmax(upper.z, points[i].z);
+    }
+
+  // Grow the cells until the grid is a sane size
+  cell = cellSize > 0 ? cellSize : 1.0;
+  while( true )
+    {
+      dims[0] = (int)((upper.x - lower.x) / cell) + 1;
+      dims[1] = (int)((upper.y - lower.y) / cell) + 1;
+      dims[2] = (int)((upper.z - lower.z) / cell) + 1;
+      if( (double)dims[0] * dims[1] * dims[2] <= MAX_GRID_CELLS )
+        {
+          break;
+        }
+      cell *= 2;
+    }
+
+  // Counting sort of the points into their cells
+  vector<int> owner(points.size());
+  cellStart.assign(dims[0] * dims[1] * dims[2] + 1, 0);
+  for(unsigned int i=0; i<points.size(); i++)
+    {
+      owner[i] = cellIndex( (int)((points[i].x - lower.x) / cell),
+                            (int)((points[i].y - lower.y) / cell),
+                            (int)((points[i].z - lower.z) / cell) );
+      cellStart[owner[i] + 1]++;
+    }
+  for(unsigned int i=1; i<cellStart.size(); i++)
+    {
+      cellStart[i] += cellStart[i-1];
+    }
+  vector<unsigned int> fill(cellStart.begin(), cellStart.end() - 1);
+  cellItems.resize(points.size());
+  for(unsigned int i=0; i<points.size(); i++)
+    {
+      cellItems[ fill[owner[i]]++ ] = i;
+    }
+}
+
+void NeighborGrid::query(const Coordinates& p, float radius, vector<unsigned int>& found) const
+{
+  if( cellItems.empty() )
+    {
+      return;
+    }
+
+  // Nothing can be found if the sphere misses the box entirely
+  if( p.x + radius < lower.x || p.x - radius > upper.x ||
+      p.y + radius < lower.y || p.y - radius > upper.y ||
+      p.z + radius < lower.z || p.z - radius > upper.z )
+    {
+      return;
+    }
+
+  int lo[3], hi[3];
+  lo[0] = max(0, (int)floor((p.x - radius - lower.x) / cell));
+  lo[1] = max(0, (int)floor((p.y - radius - lower.y) / cell));
+  lo[2] = max(0, (int)floor((p.z - radius - lower.z) / cell));
+  hi[0] = min(dims[0] - 1, (int)floor((p.x + radius - lower.x) / cell));
+  hi[1] = min(dims[1] - 1, (int)floor((p.y + radius - lower.y) / cell));
+  hi[2] = min(dims[2] - 1, (int)floor((p.z + radius - lower.z) / cell));
+
+  for(int i=lo[0]; i<=hi[0]; i++)
+    {
+      for(int j=lo[1]; j<=hi[1]; j++)
+        {
+          for(int k=lo[2]; k<=hi[2]; k++)
+            {
+              int c = cellIndex(i, j, k);
+              for(unsigned int n=cellStart[c]; n<cellStart[c+1]; n++)
+                {
+                  found.push_back(cellItems[n]);
+                }
+            }
+        }
+    }
+}
@@ -36,6 +36,10 @@
 /*************************************************************************************************/
 
 #include "Options.hpp"
+#include "Atom.hpp"
+#include "SpaceCurve.hpp"
+#include "HydrogenCache.hpp"
+#include "BabelPool.hpp"
 #include "CoutColors.hpp"
 
 // Initialize the Options to empty stuff
@@ -53,6 +57,22 @@ Options::Options()
   threshold       = 7.0;
   numLigands      = 0;
   resolution      = 99999.0;
+  crystalContacts = false;
+  assembly        = 0;
+  queryfile       = NULL;
+  verletSkin      = 0;
+  fixedPoint      = false;
+  conformer       = CONFORMER_ALL;
+  order           = ORDER_SEQUENCE;
+  hydrogens       = HYDROGENS_BABEL;
+  protonate       = PROTONATE_RESIDUE;
+  workers         = 0;
+  workerTimeout   = BABEL_WORKER_TIMEOUT;
+  candidatesOut   = NULL;
+  candidatesIn    = NULL;
+  shard           = 0;
+  shards          = 1;
+  minEstimate     = 0;
 }
 
 // Intialize options then parse the cmd line arguments
@@ -71,6 +91,22 @@ Options::Options( int argc, char **argv )
   chain_list      = NULL;
   extension       = ".pdb.gz";
   resolution      = 99999.0;
+  crystalContacts = false;
+  assembly        = 0;
+  queryfile       = NULL;
+  verletSkin      = 0;
+  fixedPoint      = false;
+  conformer       = CONFORMER_ALL;
+  order           = ORDER_SEQUENCE;
+  hydrogens       = HYDROGENS_BABEL;
+  protonate       = PROTONATE_RESIDUE;
+  workers         = 0;
+  workerTimeout   = BABEL_WORKER_TIMEOUT;
+  candidatesOut   = NULL;
+  candidatesIn    = NULL;
+  shard           = 0;
+  shards          = 1;
+  minEstimate     = 0;
   parseCmdline( argc, argv );
 }
 
@@ -100,6 +136,51 @@ void printHelp()
   cerr << "                      " << " \"PO4,2HP,PI,2PO,PO3\""                                        << endl;
   cerr << "-c or --resolution    " << "Resolution cut-off.  Will only look at the PDBs with"           << endl;
   cerr << "                      " << " a resolution <= specified value (default: 2 Angstroms)"        << endl;
+  cerr << "-x or --crystal       " << "Also look for interactions with crystal symmetry mates"         << endl;
+  cerr << "                      " << " using the CRYST1 and REMARK 290 SMTRY records"                 << endl;
+  cerr << "-b or --assembly      " << "Also look between the chain copies of biological assembly N"    << endl;
+  cerr << "                      " << " as given by the REMARK 350 BIOMT records"                      << endl;
+  cerr << "-q or --queries       " << "File of searches to run over the PDBs in a single pass"         << endl;
+  cerr << "                      " << " one search per line with the fields (blank separated):"        << endl;
+  cerr << "                      " << " residues ligands threshold samechain outputfile"               << endl;
+  cerr << "                      " << " e.g. \"PHE;GLU,ASP PO4,2HP 7.0 0 out.csv\" (- for no ligands)" << endl;
+  cerr << "                      " << " -r, -l, -t, -s, and -o are not needed with this"               << endl;
+  cerr << "-v or --verlet        " << "Keep the residue pairs within threshold + the given skin from"  << endl;
+  cerr << "                      " << " one model to the next (e.g. 2 A for NMR ensembles)"           << endl;
+  cerr << "-f or --fixed-point   " << "Round the centers to whole milli-Angstroms and compare their"   << endl;
+  cerr << "                      " << " distances in integers, so the threshold test is the same on"   << endl;
+  cerr << "                      " << " every machine (the centers and angles stay floating point)"    << endl;
+  cerr << "-a or --conformer     " << "Read only one alternate location of every residue:"            << endl;
+  cerr << "                      " << " first or highest-occupancy (default: all of them)"            << endl;
+  cerr << "-m or --order         " << "Order the residues are searched in: sequence (default),"        << endl;
+  cerr << "                      " << " morton, or hilbert to walk them along a space-filling curve."  << endl;
+  cerr << "                      " << " Experimental: only the walk changes, the residues stay where"  << endl;
+  cerr << "                      " << " they are in memory, and no speedup has been measured"         << endl;
+  cerr << "-H or --hydrogens     " << "Who adds the hydrogens: babel (default), native to place them"  << endl;
+  cerr << "                      " << " with idealised geometry, or compare to use Babel's and report" << endl;
+  cerr << "                      " << " how many native ones are more than 0.1 A from them.  How well" << endl;
+  cerr << "                      " << " native matches Babel has not been verified yet"              << endl;
+  cerr << "-P or --protonate     " << "How Babel is called: residue (default) for each residue as a"   << endl;
+  cerr << "                      " << " pair needs it, or model for all of them in one molecule"       << endl;
+  cerr << "-w or --workers       " << "Run Babel in this many worker processes, so that a crash or"    << endl;
+  cerr << "                      " << " hang loses only its residues.  The pairs are held back so"     << endl;
+  cerr << "                      " << " their residues can be split over the workers in batches"       << endl;
+  cerr << "                      " << " (default: 0, in-process)"                                      << endl;
+  cerr << "-W or --worker-timeout"                                                                   << endl;
+  cerr << "                      " << "Seconds a worker gets for a batch before it is restarted"      << endl;
+  cerr << "                      " << " (default: 120, 0 for no limit)"                                << endl;
+  cerr << "-k or --write-candidates"                                                                 << endl;
+  cerr << "                      " << "Only search, writing the pairs to this file for --read-candidates" << endl;
+  cerr << "                      " << " to add the hydrogens to later (-o is not needed)"              << endl;
+  cerr << "-K or --read-candidates"                                                                  << endl;
+  cerr << "                      " << "Add the hydrogens to the pairs of this candidate file instead"  << endl;
+  cerr << "                      " << " of searching the PDB files (-p and -r are not needed)"          << endl;
+  cerr << "-S or --shard         " << "i/n: with -K, only do every nth model of the file, starting"    << endl;
+  cerr << "                      " << " with the ith (0 to n-1), so n runs can split it up.  Its"      << endl;
+  cerr << "                      " << " GAMESS files go in the folder x(i+1) of the -g folder"         << endl;
+  cerr << "-E or --min-estimate  " << "With -g, only write GAMESS input for pairs whose classical"     << endl;
+  cerr << "                      " << " estimate (charge-quadrupole and induced dipole) binds them by"  << endl;
+  cerr << "                      " << " at least this many kcal/mol (default: 0, all pairs)"           << endl;
 }
 
 // Return true of cmd line parsing failed, false otherwise
@@ -128,12 +209,27 @@ void Options::parseCmdline( int argc, char **argv )
       {"ligands",       required_argument, 0, 'l'},
       {"gamess",        required_argument, 0, 'g'},
       {"resolution",    required_argument, 0, 'c'},
+      {"crystal",       no_argument,       0, 'x'},
+      {"assembly",      required_argument, 0, 'b'},
+      {"queries",       required_argument, 0, 'q'},
+      {"verlet",        required_argument, 0, 'v'},
+      {"fixed-point",   no_argument,       0, 'f'},
+      {"conformer",     required_argument, 0, 'a'},
+      {"order",         required_argument, 0, 'm'},
+      {"hydrogens",     required_argument, 0, 'H'},
+      {"protonate",     required_argument, 0, 'P'},
+      {"workers",       required_argument, 0, 'w'},
+      {"worker-timeout",required_argument, 0, 'W'},
+      {"write-candidates", required_argument, 0, 'k'},
+      {"read-candidates",  required_argument, 0, 'K'},
+      {"shard",         required_argument, 0, 'S'},
+      {"min-estimate",  required_argument, 0, 'E'},
       {0, 0, 0, 0}
     };
   int option_index;
   bool indir = false;
   // Go through the options and set them to variables
-  while( !( ( c = getopt_long(argc, argv, "hp:o:L:C:e:t:sr:l:g:c:", long_options, &option_index) ) < 0 ) )
+  while( !( ( c = getopt_long(argc, argv, "hp:o:L:C:e:t:sr:l:g:c:xb:q:v:fa:m:H:P:w:W:k:K:S:E:", long_options, &option_index) ) < 0 ) )
     {
     switch(c)
       {
@@ -192,39 +288,15 @@ void Options::parseCmdline( int argc, char **argv )
         break;
 
       case 'r':
-        {
-          // Get the two lists of residues
-          vector<string> temp = split( (string)optarg, ';' );
-          if(temp.size() != 2)
-            {
-              cerr << red << "Error" << reset << ": Residue string must have 1 semicolon. No more, no less." << endl;
-              printHelp();
-              exit(1);
-            }
-          // Get the first list of residues
-          this->residue1 = split( temp[0], ',' );
-          // Get the second list of residues
-          this->residue2 = split( temp[1], ',' );
-        }
+        if( !setResidues( (string)optarg ) )
+          {
+            printHelp();
+            exit(1);
+          }
         break;
 
       case 'l':
-        {
-          // Get the list of ligands
-          this->ligands = split( (string)optarg, ',' );
-          this->numLigands = this->ligands.size();
-
-          // This is prepend spaces to the names with less than 3 chars
-          // since it appears that the names in the PDB are right 
-          // justified
-          for(unsigned int i=0; i < this->numLigands; i++)
-            {
-              if(this->ligands[i].length() == 2)
-                this->ligands[i] = " " + this->ligands[i];
-              if(this->ligands[i].length() == 1)
-                this->ligands[i] = "  " + this->ligands[i];
-            }
-        }
+        setLigands( (string)optarg );
         break;
 
       case 'g':
@@ -254,6 +326,168 @@ void Options::parseCmdline( int argc, char **argv )
           break;
         }
 
+      case 'x':
+        // user wants to look across crystal contacts too
+        this->crystalContacts = true;
+        break;
+
+      case 'b':
+        // user wants the interfaces of a biological assembly too
+        if( !from_string<int>(assembly, optarg, dec) || assembly < 1 )
+          {
+            cerr << red << "Error" << reset << ": please input a biomolecule number (1 or more) for the assembly!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'q':
+        queryfile = optarg;
+        break;
+
+      case 'v':
+        if( !from_string<float>(verletSkin, optarg, dec) || verletSkin <= 0 )
+          {
+            cerr << red << "Error" << reset << ": please input a positive number for the Verlet skin!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'f':
+        fixedPoint = true;
+        break;
+
+      case 'a':
+        if( strcmp(optarg, "first") == 0 )
+          {
+            conformer = CONFORMER_FIRST;
+          }
+        else if( strcmp(optarg, "highest-occupancy") == 0 )
+          {
+            conformer = CONFORMER_HIGHEST_OCCUPANCY;
+          }
+        else if( strcmp(optarg, "all") == 0 )
+          {
+            conformer = CONFORMER_ALL;
+          }
+        else
+          {
+            cerr << red << "Error" << reset << ": the conformer must be first, highest-occupancy, or all!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'm':
+        if( strcmp(optarg, "sequence") == 0 )
+          {
+            order = ORDER_SEQUENCE;
+          }
+        else if( strcmp(optarg, "morton") == 0 )
+          {
+            order = ORDER_MORTON;
+          }
+        else if( strcmp(optarg, "hilbert") == 0 )
+          {
+            order = ORDER_HILBERT;
+          }
+        else
+          {
+            cerr << red << "Error" << reset << ": the order must be sequence, morton, or hilbert!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'H':
+        if( strcmp(optarg, "babel") == 0 )
+          {
+            hydrogens = HYDROGENS_BABEL;
+          }
+        else if( strcmp(optarg, "native") == 0 )
+          {
+            hydrogens = HYDROGENS_NATIVE;
+          }
+        else if( strcmp(optarg, "compare") == 0 )
+          {
+            hydrogens = HYDROGENS_COMPARE;
+          }
+        else
+          {
+            cerr << red << "Error" << reset << ": the hydrogens must be babel, native, or compare!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'P':
+        if( strcmp(optarg, "residue") == 0 )
+          {
+            protonate = PROTONATE_RESIDUE;
+          }
+        else if( strcmp(optarg, "model") == 0 )
+          {
+            protonate = PROTONATE_MODEL;
+          }
+        else
+          {
+            cerr << red << "Error" << reset << ": the protonation must be residue or model!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'w':
+        if( !from_string<unsigned int>(workers, optarg, dec) )
+          {
+            cerr << red << "Error" << reset << ": please input a whole number of Babel workers!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'W':
+        if( !from_string<unsigned int>(workerTimeout, optarg, dec) )
+          {
+            cerr << red << "Error" << reset << ": please input a whole number of seconds for the worker timeout!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
+      case 'k':
+        candidatesOut = optarg;
+        break;
+
+      case 'K':
+        candidatesIn = optarg;
+        break;
+
+      case 'S':
+        {
+          vector<string> parts = split(optarg, '/');
+          if( parts.size() != 2 ||
+              !from_string<unsigned int>(shard, parts[0], dec) ||
+              !from_string<unsigned int>(shards, parts[1], dec) ||
+              shards == 0 || shard >= shards )
+            {
+              cerr << red << "Error" << reset << ": the shard must be i/n with i from 0 to n-1!" << endl;
+              printHelp();
+              exit(1);
+            }
+        }
+        break;
+
+      case 'E':
+        if( !from_string<float>(minEstimate, optarg, dec) || minEstimate < 0 )
+          {
+            cerr << red << "Error" << reset << ": please input a non-negative number of kcal/mol for the estimate cutoff!" << endl;
+            printHelp();
+            exit(1);
+          }
+        break;
+
       default:
         printHelp();
         exit(1);
@@ -270,13 +504,37 @@ void Options::parseCmdline( int argc, char **argv )
       printHelp();
       failure=true;
     }
-  else if( !pdbfile )
+  else if( candidatesIn && ( pdbfile || pdblist || chain_list || queryfile || candidatesOut ) )
+    {
+      cerr << red << "Error" << reset << ": -K reads the pairs from the candidate file; it can not be used with -p, -L, -C, -q, or -k" << endl;
+      printHelp();
+      failure=true;
+    }
+  else if( candidatesOut && ( queryfile || gamessfolder ) )
+    {
+      cerr << red << "Error" << reset << ": -k only searches; it can not be used with -q or -g" << endl;
+      printHelp();
+      failure=true;
+    }
+  else if( minEstimate > 0 && !gamessfolder )
+    {
+      cerr << red << "Error" << reset << ": -E only leaves out GAMESS input files; it needs -g" << endl;
+      printHelp();
+      failure=true;
+    }
+  else if( shards > 1 && !candidatesIn )
+    {
+      cerr << red << "Error" << reset << ": -S only splits up the candidate file read with -K" << endl;
+      printHelp();
+      failure=true;
+    }
+  else if( !pdbfile && !candidatesIn )
     {
       cerr << red << "Error" << reset << ": Must specify the PDB list file with -p or --pdblist" <<  endl;
       printHelp();
       failure=true;
     }
-  else if( !outputfile )
+  else if( !outputfile && !queryfile && !candidatesOut )
     {
       cerr << red << "Error" << reset << ": Must specify the op file with -o or --op" <<  endl;
       printHelp();
@@ -304,11 +562,43 @@ void Options::parseCmdline( int argc, char **argv )
       outputGamessINP = false;
     }
   
-  if (residue1.size() == 0 || residue2.size() == 0)
+  if ( !queryfile && !candidatesIn && (residue1.size() == 0 || residue2.size() == 0) )
     {
       cerr << red << "Error" << reset << ": -r or --residues must be used to set the residues to search for!!!" << endl;
       failure = true;
     }
 }
 
+bool Options::setResidues(const string& residues)
+{
+  // Get the two lists of residues
+  vector<string> temp = split( residues, ';' );
+  if(temp.size() != 2)
+    {
+      cerr << red << "Error" << reset << ": Residue string must have 1 semicolon. No more, no less." << endl;
+      return false;
+    }
+  // Get the first list of residues
+  this->residue1 = split( temp[0], ',' );
+  // Get the second list of residues
+  this->residue2 = split( temp[1], ',' );
+  return true;
+}
+
+void Options::setLigands(const string& ligandList)
+{
+  // Get the list of ligands
+  this->ligands = split( ligandList, ',' );
+  this->numLigands = this->ligands.size();
 
+  // This is prepend spaces to the names with less than 3 chars
+  // since it appears that the names in the PDB are right 
+  // justified
+  for(unsigned int i=0; i < this->numLigands; i++)
+    {
+      if(this->ligands[i].length() == 2)
+        this->ligands[i] = " " + this->ligands[i];
+      if(this->ligands[i].length() == 1)
+        this->ligands[i] = "  " + this->ligands[i];
+    }
+}
@@ -48,10 +48,8 @@
 #include "Utils.hpp"
 #include "../gzstream/gzstream.h"
 #include "CoutColors.hpp"
-
-#ifndef NO_BABEL
-using namespace OpenBabel;
-#endif
+#include "HydrogenPlacer.hpp"
+#include "BabelPool.hpp"
 
 // Constructor to initialize the PDB class object by 
 // ensuring all the vectors are empty
@@ -63,11 +61,11 @@ PDB::PDB()
   hetatms.clear();
   seqres.clear();
   ligands.clear();
-  conect.clear();
   models.clear();
   ligandsToFind = NULL;
   residue1      = NULL;
   residue2      = NULL;
+  conformer     = CONFORMER_ALL;
   resolution = -2;
   model_number=1;
 }
@@ -79,6 +77,7 @@ PDB::PDB(const char* fn, float res)
   ligandsToFind = NULL;
   residue1      = NULL;
   residue2      = NULL;
+  conformer     = CONFORMER_ALL;
   resolution = -2;
   model_number=1;
   parsePDB(fn, res);
@@ -91,6 +90,7 @@ PDB::PDB(istream& file, float res)
   ligandsToFind = NULL;
   residue1      = NULL;
   residue2      = NULL;
+  conformer     = CONFORMER_ALL;
   resolution = -2;
   model_number=1;
   parsePDBstream(file, res);
@@ -108,8 +108,10 @@ PDB::~PDB()
   hetatms.clear();
   seqres.clear();
   ligands.clear();
-  conect.clear();
   models.clear();
+  symmetry.clear();
+  assemblies.clear();
+  cell = UnitCell();
   resolution = -2;
   model_number=1;
 }
@@ -125,8 +127,10 @@ void PDB::clear()
   hetatms.clear();
   seqres.clear();
   ligands.clear();
-  conect.clear();
   models.clear();
+  symmetry.clear();
+  assemblies.clear();
+  cell = UnitCell();
   resolution = -2;
   model_number=1;
 }
@@ -270,6 +274,36 @@ void PDB::parsePDBstream(istream& PDBfile, float resolution)
           continue;
         }
 
+      // Grab the unit cell and the crystal symmetry operators.
+      // These are only used when looking at crystal contacts
+      found = line.find("CRYST1");
+      if( found == 0 )
+        {
+          if( !cell.parseCRYST1(line) )
+            {
+              cout << cyan << "WARNING" << reset << ": Could not read the CRYST1 line " << count << endl;
+            }
+          continue;
+        }
+      found = line.find("REMARK 290");
+      if( found == 0 )
+        {
+          if( line.find("SMTRY") != string::npos && !parseOperatorRow(line, "SMTRY", symmetry) )
+            {
+              cout << cyan << "WARNING" << reset << ": Could not read the SMTRY line " << count << endl;
+            }
+          continue;
+        }
+      found = line.find("REMARK 350");
+      if( found == 0 )
+        {
+          if( !parseAssemblyLine(line, assemblies) )
+            {
+              cout << cyan << "WARNING" << reset << ": Could not read the REMARK 350 line " << count << endl;
+            }
+          continue;
+        }
+
       // Parse the line if we are on an ATOM line
       found = line.find("ATOM");
       if( found == 0 )
@@ -292,16 +326,6 @@ void PDB::parsePDBstream(istream& PDBfile, float resolution)
           model.hetatms.push_back(h);
           continue;
         }
-
-      // Parse the line if we are on a CONECT line
-      // Used to find ligands
-      found = line.find("CONECT");
-      if( found == 0 )
-        {
-          conect.push_back(line);
-          model.conect.push_back(line);
-          continue;
-        }
     }
 
   // This checks to see if we even had a resolution line
@@ -319,13 +343,131 @@ void PDB::parsePDBstream(istream& PDBfile, float resolution)
 }
 
 #ifndef NO_BABEL
+// A residue handed to Babel, possibly along with others in the same
+// molecule, and where its hydrogens go
+class BabelFragment
+{
+public:
+  AminoAcid*         residue;
+  vector<Atom*>      given;     // Its atoms, in the order Babel gets them
+  ResidueKey         key;
+  ProtonatedResidue* hydrogens;
+
+  BabelFragment(AminoAcid& r, const vector<Atom*>& given, ProtonatedResidue* p)
+    : residue(&r), given(given), key(r.residue, given), hydrogens(p) {}
+};
+
+// Has Babel add the hydrogens to the fragments.  With a pool the
+// fragments are split evenly over its workers, and the ones whose
+// worker crashed or hung are marked as failed
+static void babelHydrogens(vector<BabelFragment>& fragments, BabelPool* pool)
+{
+  if( fragments.empty() )
+    {
+      return;
+    }
+
+  unsigned int parts = pool ? min((unsigned int)fragments.size(), pool->size()) : 1;
+  vector<HydrogenBatch> batches(parts);
+  vector<unsigned int>  firstOf(parts + 1, fragments.size());
+  for(unsigned int f=fragments.size(); f-- > 0; )
+    {
+      firstOf[(unsigned long long)f * parts / fragments.size()] = f;
+    }
+  for(unsigned int b=0; b<parts; b++)
+    {
+      for(unsigned int f=firstOf[b]; f<firstOf[b+1]; f++)
+        {
+          batches[b].addFragment(*fragments[f].residue, fragments[f].given);
+        }
+    }
+
+  vector< vector<AddedHydrogen> > added(parts);
+  vector<bool> ok(parts, true);
+  if( pool )
+    {
+      pool->run(batches, added, ok);
+    }
+  else
+    {
+      protonateBatch(batches[0], added[0]);
+    }
+
+  // Each hydrogen takes the residue fields of the atom it is on and is
+  // numbered after the atoms of its residue
+  for(unsigned int b=0; b<parts; b++)
+    {
+      vector<int> serial(firstOf[b+1] - firstOf[b], 0);
+      for(unsigned int f=firstOf[b]; f<firstOf[b+1]; f++)
+        {
+          fragments[f].hydrogens->failed = !ok[b];
+          for(unsigned int i=0; i<fragments[f].given.size(); i++)
+            {
+              serial[f - firstOf[b]] = max(serial[f - firstOf[b]], fragments[f].given[i]->serialNumber);
+            }
+        }
+      for(unsigned int i=0; i<added[b].size(); i++)
+        {
+          const AddedHydrogen& h = added[b][i];
+          BabelFragment& fragment = fragments[firstOf[b] + h.fragment];
+          fragment.hydrogens->hydrogens.push_back(makeHydrogen(*fragment.given[h.parent],
+                                                               ++serial[h.fragment],
+                                                               Coordinates(h.x, h.y, h.z)));
+          fragment.hydrogens->bondedTo.push_back(h.parent);
+        }
+    }
+}
+
+// Adds a fragment for every conformer of r that is not in cache yet,
+// with a new entry to put its hydrogens in
+static void addFragments(AminoAcid& r, HydrogenCache& cache, vector<BabelFragment>& fragments)
+{
+  // The atoms that are not used are only flagged once the centers are in
+  r.ensureCenter();
+  if( r.skip )
+    {
+      return;
+    }
+  vector<Atom*> given;
+  for(unsigned int c=0; c<r.conformers(); c++)
+    {
+      r.conformerAtoms(c, given);
+      ResidueKey key(r.residue, given);
+      if( given.empty() || cache.contains(key) )
+        {
+          continue;
+        }
+      fragments.push_back(BabelFragment(r, given, &cache.insert(key)));
+    }
+}
+
+// Protonates the fragments in one call of babelHydrogens ahead of the
+// pairs that need them.  The residues of a batch whose worker crashed
+// or hung are taken out of cache again, so that the pairs protonate
+// them one at a time and only the one Babel cannot handle is lost
+static void protonateFragments(vector<BabelFragment>& fragments, HydrogenCache& cache)
+{
+  babelHydrogens(fragments, cache.pool);
+  for(unsigned int i=0; i<fragments.size(); i++)
+    {
+      if( fragments[i].hydrogens->failed )
+        {
+          cache.erase(fragments[i].key);
+          continue;
+        }
+      removeExcessHydrogens(fragments[i].residue->residue, fragments[i].given, *fragments[i].hydrogens);
+      cache.preloaded++;
+    }
+}
+
 // This function will call the Babel library to add 
 // hydrogens to the residues
-void PDB::addHydrogensToPair(AminoAcid& a, AminoAcid& b, int cd1, int cd2)
+bool PDB::addHydrogensToPair(AminoAcid& a,
+                             AminoAcid& b,
+                             const vector<Atom*>& givenA,
+                             const vector<Atom*>& givenB,
+                             HydrogenCache& cache)
 {
-  OBMol mol;
-  string addedH;
-  istringstream tempss;
   bool ligand;
   if(b.atom[0]->line.find("HETATM") != string::npos)
     {
@@ -336,98 +478,146 @@ void PDB::addHydrogensToPair(AminoAcid& a, AminoAcid& b, int cd1, int cd2)
       ligand = false;
     }
 
-  // This section is just to suppress all of the 
-  // warning message that aren't important to us
-  {
-    OBConversion apiConv;
-    OBFormat* pAPI = OBConversion::FindFormat("obapi");
-    if(pAPI)
-      {
-        apiConv.SetOutFormat(pAPI);
-        apiConv.AddOption("errorlevel", OBConversion::GENOPTIONS, "0");
-        apiConv.Write(NULL, &std::cout);
-      }
-  }
-
-  // Now, let's pack up the information into a string
-  string packedFile="";
-  for(unsigned int i=0; i < a.altlocs[cd1].size(); i++)
-    {
-      if( !a.altlocs[cd1][i]->skip )
-        {
-          packedFile += a.altlocs[cd1][i]->line + "\n";
-        }
+  // Each residue gets its hydrogens on its own.  The two are not bonded
+  // to each other, so Babel would have placed the same ones with both
+  // of them in the molecule
+  ProtonatedResidue& ha = protonateResidue(a, givenA, cache);
+  ProtonatedResidue& hb = protonateResidue(b, givenB, cache);
+  if( ha.failed || hb.failed )
+    {
+      return false;
     }
-  
-  int cd2_al = cd2;
-  if(b.residue == "ASP" || b.residue == "GLU")
+
+  if( hb.corrected )
     {
-      cd2_al = cd2%(b.altlocs.size());
+      cout << brown << "Corrected" << reset << ": " << filename
+           << " | " << a.residue << a.atom[0]->resSeq << " Chain " << a.atom[0]->chainID
+           << " - " << b.residue << b.atom[0]->resSeq << " Chain " << b.atom[0]->chainID << endl;
     }
 
-  for(unsigned int i=0; i < b.altlocs[cd2_al].size(); i++)
+  // The atoms of both residues and then the hydrogens of both, which is
+  // the order Babel writes them out in.  The ligand goes in with the
+  // HETATMs just for the sake of STAAR
+  const vector<Atom*>*     given[2] = { &givenA, &givenB };
+  const ProtonatedResidue* added[2] = { &ha, &hb };
+  vector<Atom>*            into[2]  = { &this->atoms, ligand ? &this->hetatms : &this->atoms };
+  for(int p=0; p<2; p++)
     {
-      if( !b.altlocs[cd2_al][i]->skip )
+      for(unsigned int i=0; i<given[p]->size(); i++)
         {
-            packedFile += b.altlocs[cd2_al][i]->line + "\n";
+          into[p]->push_back(*(*given[p])[i]);
+          Atom& copy = into[p]->back();
+          string symbol = elementSymbol(copy);
+          copy.element = string(symbol.size() < 2 ? 2 - symbol.size() : 0, ' ') + symbol;
+          copy.skip = false;
         }
     }
-  packedFile += a.makeConect(cd1);
-  packedFile += b.makeConect(cd2_al);
-
-
-  // Now, let's set up some Babel information
-  // First, we get the PDB format to tell
-  // Babel how to read the information and 
-  // how to output it
-  OBFormat* pdbformat = this->conv.FindFormat("pdb");
-  this->conv.SetInFormat(pdbformat);
-  this->conv.SetOutFormat(pdbformat);
-
-  // Here is where Babel reads everything
-  // and adds hydrogens to the pair
-  // TO ADD: option to set pH
-  this->conv.ReadString(&mol,packedFile);
-  mol.AddHydrogens(false,true,PH_LEVEL);
-
-  // Let's write the newly written hydrogens to 
-  // a string and parse it
-  addedH = this->conv.WriteString(&mol);
-  tempss.str(addedH);
-
-  // This ensures that the ligand hydrogens are labeled as
-  // HETATM instead of ATOM just for the sake of STAAR. 
-  // This may be wrong, but it should be fine since we are
-  // stripping out that information later when we write 
-  // the GAMESS inp files
-  if( ligand )
-    {
-      string line;
-      string f = "";
-      while( getline(tempss,line) )
-        {
-          if( line.find(b.residue) != string::npos )
-            {
-              line.replace(0,6,"HETATM");
-            }
-          f += line + "\n";
-        }
-      tempss.seekg(ios_base::beg);
-      tempss.clear();
-      tempss.str(f);
+  for(int p=0; p<2; p++)
+    {
+      into[p]->insert(into[p]->end(), added[p]->hydrogens.begin(), added[p]->hydrogens.end());
     }
 
   this->failure = false;
-  this->parsePDB(tempss,99999.99);
 
   // This is just to ensure that all of the atoms
-  // are grouped together because Babel just 
-  // appends the H to the end of the file
+  // are grouped together because the hydrogens
+  // come after all of the atoms
   if( !ligand )
       this->sortAtoms();
 
   // Split the atoms up into amino acids and chains
   this->populateChains(true);
+  return true;
+}
+
+ProtonatedResidue& PDB::protonateResidue(AminoAcid& r,
+                                         const vector<Atom*>& given,
+                                         HydrogenCache& cache)
+{
+  ResidueKey key(r.residue, given);
+  ProtonatedResidue* cached = cache.find(key);
+  if( cached )
+    {
+      return *cached;
+    }
+
+  ProtonatedResidue& p = cache.insert(key);
+  if( cache.engine == HYDROGENS_NATIVE && placeHydrogens(r.residue, given, p) )
+    {
+      return p;
+    }
+
+  // A residue Babel crashed or hung on stays in cache as failed, so it
+  // is not tried again for every pair it is in
+  vector<BabelFragment> fragments;
+  if( !given.empty() )
+    {
+      fragments.push_back(BabelFragment(r, given, &p));
+    }
+  babelHydrogens(fragments, cache.pool);
+  if( p.failed )
+    {
+      return p;
+    }
+  removeExcessHydrogens(r.residue, given, p);
+
+  // Check the hydrogens we would have placed against Babel's
+  ProtonatedResidue ours;
+  if( cache.engine == HYDROGENS_COMPARE && placeHydrogens(r.residue, given, ours) )
+    {
+      float worst = compareHydrogens(ours, p);
+      cache.compared++;
+      if( worst < 0 || worst > HYDROGEN_TOLERANCE )
+        {
+          cache.disagreed++;
+        }
+      if( worst > cache.worst )
+        {
+          cache.worst = worst;
+        }
+    }
+  return p;
+}
+
+void PDB::protonateModel(HydrogenCache& cache)
+{
+  vector<BabelFragment> fragments;
+  for(unsigned int i=0; i<chains.size(); i++)
+    {
+      for(unsigned int j=0; j<chains[i].aa.size(); j++)
+        {
+          if( !chains[i].aa[j].skip )
+            {
+              addFragments(chains[i].aa[j], cache, fragments);
+            }
+        }
+    }
+  for(unsigned int i=0; i<ligands.size(); i++)
+    {
+      if( !ligands[i]->skip )
+        {
+          addFragments(*ligands[i], cache, fragments);
+        }
+    }
+
+  protonateFragments(fragments, cache);
+}
+
+void PDB::protonateAhead(const vector<AminoAcid*>& residues,
+                         const vector< vector<Atom*> >& given,
+                         HydrogenCache& cache)
+{
+  vector<BabelFragment> fragments;
+  for(unsigned int i=0; i<residues.size(); i++)
+    {
+      ResidueKey key(residues[i]->residue, given[i]);
+      if( given[i].empty() || cache.contains(key) )
+        {
+          continue;
+        }
+      fragments.push_back(BabelFragment(*residues[i], given[i], &cache.insert(key)));
+    }
+  protonateFragments(fragments, cache);
 }
 #endif
 
@@ -451,8 +641,45 @@ void PDB::setLigandsToFind(vector<string>* l)
   ligandsToFind = l;
 }
 
+void PDB::setConformer(int policy)
+{
+  conformer = policy;
+}
+
+// Picks the alternate location id that a residue is cut down to.  For
+// the highest occupancy, the occupancies of the atoms with each id are
+// averaged, and a tie goes to the id that came first
+static char pickConformer(vector<Atom*>& atoms, vector<char>& ids, int policy)
+{
+  if( policy == CONFORMER_FIRST )
+    {
+      return ids[0];
+    }
+  char best = ids[0];
+  double bestOccupancy = -1;
+  for(unsigned int j=0; j<ids.size(); j++)
+    {
+      double sum = 0;
+      int count = 0;
+      for(unsigned int i=0; i<atoms.size(); i++)
+        {
+          if( atoms[i]->altLoc == ids[j] )
+            {
+              sum += atoms[i]->occupancy;
+              count++;
+            }
+        }
+      if( count && sum / count > bestOccupancy )
+        {
+          bestOccupancy = sum / count;
+          best = ids[j];
+        }
+    }
+  return best;
+}
+
 // Organizes the the data by chains
-void PDB::populateChains(bool center)
+void PDB::populateChains(bool center, bool lazy)
 {
   // Flag to hold the current chain id
   char chainID =  '-';
@@ -501,13 +728,40 @@ void PDB::populateChains(bool center)
             }
         }
       i--;
+
+      // Cut the residue down to a single conformer.  It still gets the
+      // M code since it did have alternate locations
+      if( conformer != CONFORMER_ALL && !altloc_ids.empty() )
+        {
+          char keep = pickConformer(aa.atom, altloc_ids, conformer);
+          vector<Atom*> kept;
+          for(unsigned int j=0; j<aa.atom.size(); j++)
+            {
+              if( aa.atom[j]->altLoc == ' ' || aa.atom[j]->altLoc == keep )
+                {
+                  kept.push_back(aa.atom[j]);
+                }
+            }
+          aa.atom.swap(kept);
+          altloc_ids.clear();
+          aa.altLoc = true;
+        }
       aa.determineAltLoc(altloc_ids);
       aa.residue = atoms[i].residueName;
       vector<string>::iterator found1 = find(residue1->begin(), residue1->end(), aa.residue);
       vector<string>::iterator found2 = find(residue2->begin(), residue2->end(), aa.residue);
       if( found1 != residue1->end() || found2 != residue2->end())
         {
-          aa.calculateCenter(center);
+          // Put the centers off until the residue has a partner nearby
+          if( lazy && !center )
+            {
+              aa.centered = false;
+              aa.setRepresentative();
+            }
+          else
+            {
+              aa.calculateCenter(center);
+            }
         }
       else
         {
@@ -579,6 +833,7 @@ void PDB::populateChains(bool center)
 // ligand in r2
 void PDB::getPair(int& resSeq1, 
                   int& resSeq2, 
+                  const string& aromatic,
                   Residue* r1, 
                   Residue* r2,
                   bool ligand)
@@ -595,7 +850,7 @@ void PDB::getPair(int& resSeq1,
           // If the benzene was naturally first,
           // it is in the first chain while the formate
           // is in the second chain
-          if(this->chains[0].aa[0].residue == "PHE")
+          if(this->chains[0].aa[0].residue == aromatic)
             {
               *r1 = this->chains[0].aa[0];
               *r2 = this->chains[1].aa[0];
@@ -613,7 +868,7 @@ void PDB::getPair(int& resSeq1,
           // If the benzene was naturally first,
           // it is in the first chain while the formate
           // is in the second chain
-          if(this->chains[0].aa[0].residue == "PHE")
+          if(this->chains[0].aa[0].residue == aromatic)
             {
               *r1 = this->chains[0].aa[0];
               *r2 = this->chains[0].aa[1];
@@ -626,12 +881,6 @@ void PDB::getPair(int& resSeq1,
               *r2 = this->chains[0].aa[0];
             }
         }
-      if( (*r2).removeExcessHydrogens(this->conect) )
-        {
-          cout << brown << "Corrected" << reset << ": " << filename
-               << " | " << (*r1).residue << (*r1).atom[0]->resSeq << " Chain " << (*r1).atom[0]->chainID
-               << " - " << (*r2).residue << (*r2).atom[0]->resSeq << " Chain " << (*r2).atom[0]->chainID << endl;
-        }
     }
   else
     {
@@ -666,6 +915,38 @@ void PDB::sortAtoms()
   sort(atoms.begin(),atoms.end());
 }
 
+void PDB::orderResidues(int curve)
+{
+  searchOrder.clear();
+  vector<Coordinates> points;
+  for(unsigned int i=0; i<chains.size(); i++)
+    {
+      for(unsigned int j=0; j<chains[i].aa.size(); j++)
+        {
+          if( chains[i].aa[j].atom.empty() )
+            {
+              continue;
+            }
+          ResidueSlot slot;
+          slot.chain = i;
+          slot.index = j;
+          slot.key   = 0;
+          searchOrder.push_back(slot);
+          points.push_back(chains[i].aa[j].atom[0]->coord);
+        }
+    }
+
+  vector<unsigned int> keys;
+  curveKeys(points, curve, keys);
+  for(unsigned int i=0; i<searchOrder.size(); i++)
+    {
+      searchOrder[i].key = keys[i];
+    }
+
+  // Residues in the same cell stay in chain order
+  stable_sort(searchOrder.begin(), searchOrder.end());
+}
+
 
 ostream& operator<<(ostream& output, const PDB& p) 
 {
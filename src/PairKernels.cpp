@@ -0,0 +1,794 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: PairKernels.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Pair evaluation compiled for every kind of aromatic and anion,
+//               and the table that picks one for a pair of residue names
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include "PairKernels.hpp"
+#include "Distance.hpp"
+#include "Geometry.hpp"
+#include "CandidateFile.hpp"
+#include "CoutColors.hpp"
+
+// What the kernels need to know about each kind of aromatic: which
+// plane_info entries of the center of charge the ring plane goes through
+// (see the CHARGE_WEIGHTED entry of PHE and TYR in ResidueTable.cpp),
+// which atoms a center was made from, and its quadrupole moment and
+// polarizability (PHE and TYR have one center for each conformer)
+struct BenzeneRing
+{
+  enum { planeOrigin = 0, planeFirst = 1, planeSecond = 2 };
+  static void centerAtoms(AminoAcid& aa, unsigned int center, vector<Atom*>& given)
+  {
+    aa.conformerAtoms(center, given);
+  }
+  static float quadrupole() { return QUADRUPOLE_BENZENE; }
+  static float polarizabilityNormal() { return POLARIZABILITY_BENZENE_NORMAL; }
+  static float polarizabilityPlane()  { return POLARIZABILITY_BENZENE_PLANE; }
+};
+
+// And about each kind of anion: whether it is a HETATM ligand, and
+// whether its hydrogens are taken out one at a time with a GAMESS input
+// file for each
+// (a carboxylate has a center on each of its oxygens in every conformer,
+// and the phosphates have one for each combination of the alternate
+// locations of their atoms)
+struct Carboxylate
+{
+  enum { ligand = 0, oneHydrogenAtATime = 0 };
+  static void centerAtoms(AminoAcid& aa, unsigned int center, vector<Atom*>& given)
+  {
+    aa.conformerAtoms(center % aa.conformers(), given);
+  }
+};
+
+struct Phosphate
+{
+  enum { ligand = 1, oneHydrogenAtATime = 1 };
+  static void centerAtoms(AminoAcid& aa, unsigned int center, vector<Atom*>& given)
+  {
+    aa.combinationAtoms(center, given);
+  }
+};
+
+struct HydrogenPhosphate
+{
+  enum { ligand = 1, oneHydrogenAtATime = 0 };
+  static void centerAtoms(AminoAcid& aa, unsigned int center, vector<Atom*>& given)
+  {
+    aa.combinationAtoms(center, given);
+  }
+};
+
+struct Phosphonate
+{
+  enum { ligand = 1, oneHydrogenAtATime = 0 };
+  static void centerAtoms(AminoAcid& aa, unsigned int center, vector<Atom*>& given)
+  {
+    aa.combinationAtoms(center, given);
+  }
+};
+
+PairContext::PairContext(float threshold,
+                         PDB& PDBfile,
+                         char* gamessfolder,
+                         ofstream& output,
+                         char contact)
+  : threshold(threshold),
+    PDBfile(PDBfile),
+    gamessfolder(gamessfolder),
+    output(output),
+    contact(contact),
+    candidates(NULL),
+    queue(NULL),
+    minEstimate(0)
+{
+}
+
+// False if the centers of charge of the atoms given are certain to be
+// further apart than threshold once the hydrogens are in, going by
+// chargeCenterBound.  Those pairs would only be skipped by
+// postHydrogenGeometry after the hydrogens were paid for
+static bool reachableWithHydrogens(const PairCandidate& pair, float threshold)
+{
+  Coordinates p1, p2;
+  float r1, r2;
+  if( !pair.aa1->chargeCenterBound(pair.given1, &p1, &r1) ||
+      !pair.aa2->chargeCenterBound(pair.given2, &p2, &r2) )
+    {
+      return true;
+    }
+  return p1.distance(p2) - r1 - r2 <= threshold + CENTER_BOUND_SLACK;
+}
+
+// Distances and angles between the aromatic's center of mass and the
+// anion's center of charge, once the hydrogens are in.  Returns false
+// if the pair moved out of threshold or the geometry is degenerate
+template<class Ring>
+static bool postHydrogenGeometry(AminoAcid& aa1,
+                                 AminoAcid& aa2,
+                                 const Coordinates& closestOxygen,
+                                 float threshold,
+                                 float* dist,
+                                 float* distOxy,
+                                 float* distOxy2,
+                                 float* angle,
+                                 float* angleOxy,
+                                 float* angleOxy2)
+{
+  // These are the 3 points in the benzene ring of the center of charge
+  Coordinates dBenzene1 = *aa1.center[0].plane_info[Ring::planeFirst]  - *aa1.center[0].plane_info[Ring::planeOrigin];
+  Coordinates dBenzene2 = *aa1.center[0].plane_info[Ring::planeSecond] - *aa1.center[0].plane_info[Ring::planeOrigin];
+
+  // These values are just to match the Perl script
+  float a = dBenzene1.x;
+  float b = dBenzene1.y;
+  float c = dBenzene1.z;
+  float d = dBenzene2.x;
+  float e = dBenzene2.y;
+  float f = dBenzene2.z;
+
+  // Get the perpendicular vector
+  float xp = b * f - c * e;
+  float yp = c * d - a * f;
+  float zp = a * e - b * d;
+  Coordinates perp(xp, yp, zp);  
+
+  // Calculate the distance between the centers
+  // This is the vector pointing from the benzene center to formate center of charge
+  Coordinates distance = aa2.center[0] - aa1.center[0];
+
+  
+  float num = dotProduct(perp, distance);
+  float perpnorm = perp.norm();
+  float distFromMassToChg = distance.norm();
+  float denom = perpnorm * distFromMassToChg;
+
+  if(distFromMassToChg > threshold)
+    {
+      cout << gray << "Note" << reset << ": post hydrogen distance, " << distFromMassToChg <<" > "<< threshold << "A.  Skipping." << endl;
+      return false;
+    }
+
+  if(denom == 0)
+    {
+      cerr << red << "Error" << reset << ": denom is zero.  Skipping residue" << endl;
+      return false;
+    }  
+
+  // We already have one of the oxygens as an input param
+  // Now let's find the other one
+  Coordinates otherOxygen;
+  for(int i = 0; i < aa2.atom.size(); i++)
+    {
+      // Only look at the oxygen atoms
+      if(aa2.atom[i]->element == "O")
+        {
+          // Make sure this oxygen is different than the closest one
+          if(aa2.atom[i]->coord.x != closestOxygen.x ||
+             aa2.atom[i]->coord.y != closestOxygen.y ||
+             aa2.atom[i]->coord.z != closestOxygen.z)
+            {
+              otherOxygen = aa2.atom[i]->coord;
+            }
+        }
+    }
+
+  // Vector between benzene center of mass and closest oxygen
+  Coordinates oD  = closestOxygen - aa1.center[0];
+  // Vector between benzene center of mass and the other oxygen
+  Coordinates oD2 = otherOxygen - aa1.center[0];
+  
+  // Oxygen dot product
+  float oxy_numerator  = dotProduct(perp, oD); 
+  float oxy_numerator2 = dotProduct(perp, oD2); 
+
+  // distance from beneze center and the oxygens
+  float distFromCenterToOxy  = oD.norm();
+  float distFromCenterToOxy2 = oD2.norm();
+
+  // Denominators
+  float oxy_denom  = perpnorm * distFromCenterToOxy;
+  float oxy_denom2 = perpnorm * distFromCenterToOxy2;
+
+  if(oxy_denom == 0)
+    {
+      cerr << red << "Error" << reset << ": oxy_denom are zero.  Skipping residue" << endl;
+      return false;
+    }
+  
+  float u = num / denom;
+  float uOxy  = oxy_numerator  / oxy_denom;
+  float uOxy2 = oxy_numerator2 / oxy_denom2;
+
+  // Force u to be [-1,1]
+  if(u > 1)       u =  1;
+  else if(u < -1) u = -1;
+
+  if(uOxy > 1)       uOxy =  1;
+  else if(uOxy < -1) uOxy = -1;
+
+  if(uOxy2 > 1)       uOxy2 =  1;
+  else if(uOxy2 < -1) uOxy2 = -1;
+
+  // Get the angle and change it to degrees
+  // take absolute vale to put it in [0,90]
+  *dist      = distFromMassToChg;
+  *distOxy   = distFromCenterToOxy;
+  *distOxy2  = distFromCenterToOxy2;
+  *angle     = fabs( 90 - acos(u)     * 180/3.14159 );
+  *angleOxy  = fabs( 90 - acos(uOxy)  * 180/3.14159 );
+  *angleOxy2 = fabs( 90 - acos(uOxy2) * 180/3.14159 );
+  return true;
+}
+
+// Interaction energy in kcal/mol of a point charge q at r Angstroms from
+// the center of the ring Ring, elevation degrees out of the ring plane.
+// With t the angle from the ring normal, in atomic units, it is the
+// quadrupole term q theta (3 cos^2 t - 1) / (2 r^3), which is repulsive
+// over the face of benzene for an anion and attractive around its edge,
+// and the induced term -q^2 alpha(t) / (2 r^4), which is attractive
+// everywhere.  alpha(t) is the polarizability along the line from the
+// ring to the charge
+template<class Ring>
+static float electrostaticEstimate(float q, float r, float elevation)
+{
+  float cosNormal = sin(elevation * 3.14159 / 180);
+  float alpha = ( Ring::polarizabilityNormal() * cosNormal * cosNormal +
+                  Ring::polarizabilityPlane()  * (1 - cosNormal * cosNormal) ) *
+    BOHR_PER_ANGSTROM * BOHR_PER_ANGSTROM * BOHR_PER_ANGSTROM;
+  float rb = r * BOHR_PER_ANGSTROM;
+  float quadrupole = q * Ring::quadrupole() * (3 * cosNormal * cosNormal - 1) / (2 * rb * rb * rb);
+  float induced    = -q * q * alpha / (2 * rb * rb * rb * rb);
+  return (quadrupole + induced) * KCAL_PER_HARTREE;
+}
+
+// Numbers the GAMESS input files across all kernels
+static int numOutputted = 0;
+
+// Pairs left out of GAMESS by their estimate
+static unsigned int heldBack = 0;
+
+unsigned int gamessHeldBack()
+{
+  return heldBack;
+}
+
+// Writes the GAMESS input file (if asked for) and one row of results
+template<class Anion>
+static void writeResult(PairCandidate& pair,
+                        AminoAcid& aa1h,
+                        AminoAcid& aa2h,
+                        PairContext& ctx,
+                        float dist,
+                        float distOxy,
+                        float distOxy2,
+                        float angleh,
+                        float angleOxy,
+                        float angleOxy2,
+                        float estimate)
+{
+  AminoAcid& aa1 = *pair.aa1;
+  AminoAcid& aa2 = *pair.aa2;
+  char output_filename[1024] = "N/A";
+  if( ctx.gamessfolder && ctx.minEstimate > 0 && estimate > -ctx.minEstimate )
+    {
+      heldBack++;
+    }
+  else if( ctx.gamessfolder )
+    {
+      numOutputted++;
+      sprintf(output_filename, "%s/gamessinp-%d.inp", ctx.gamessfolder, numOutputted);
+      outputINPfile(ctx.PDBfile.filename, output_filename, aa1h, aa2h, Anion::oneHydrogenAtATime);
+    }
+
+  // and we finally output some results!
+  ctx.output << aa1.residue                        << ","
+             << aa2.residue                        << ","
+             << pair.closestDist                   << ","
+             << pair.angle                         << ","
+             << pair.angleP                        << ","
+             << pair.angle1                        << ","
+             << aa1.atom[0]->resSeq                << ","
+             << aa2.atom[0]->resSeq                << ","
+             << pair.code1 << pair.code2           << ","
+             << ctx.PDBfile.filename               << ","
+             << ctx.PDBfile.resolution             << ","
+             << ctx.PDBfile.model_number           << ","
+             << output_filename                    << ","
+             << aa1.atom[0]->chainID               << ","
+             << aa2.atom[0]->chainID               << ","
+             << pair.center1                       << ","
+             << pair.center2                       << ","
+             << aa1h.center[0]                     << ","
+             << aa2h.center[0]                     << ","
+             << dist                               << ","
+             << distOxy                            << ","
+             << distOxy2                           << ","
+             << angleh                             << ","
+             << angleOxy                           << ","
+             << angleOxy2                          << ","
+             << estimate                           << endl;
+}
+
+// Adds the hydrogens to the conformers of the pair the closest centers
+// came from, measures it again, and writes it out.  This is all that
+// is left of a pair once it is a candidate, so it runs the same on a
+// pair read back from a candidate file
+template<class Ring, class Anion>
+static void finishPair(PairCandidate& pair, PairContext& ctx)
+{
+  AminoAcid& aa1 = *pair.aa1;
+  AminoAcid& aa2 = *pair.aa2;
+  PDB pairWithHydrogen;
+
+  // Set the residues and ligands to find
+  pairWithHydrogen.setResiduesToFind(ctx.PDBfile.residue1, ctx.PDBfile.residue2);
+  pairWithHydrogen.setLigandsToFind(ctx.PDBfile.ligandsToFind);
+
+  // Set the filename
+  pairWithHydrogen.filename = ctx.PDBfile.filename;
+
+  // Add the hydrogens to the atoms the closest centers came from,
+  // reusing the ones placed for earlier pairs of this model
+  if( !pairWithHydrogen.addHydrogensToPair(aa1, aa2, pair.given1, pair.given2, ctx.PDBfile.hydrogens) )
+    {
+#ifndef DISABLE_WARNING
+      cout << cyan << "WARNING" << reset << ": no hydrogens for " << ctx.PDBfile.filename
+           << " | " << aa1.residue << aa1.atom[0]->resSeq << " Chain " << aa1.atom[0]->chainID
+           << " - " << aa2.residue << aa2.atom[0]->resSeq << " Chain " << aa2.atom[0]->chainID
+           << "; pair skipped" << endl;
+#endif
+      return;
+    }
+
+  // Separate the pair into 2 variables
+  AminoAcid aa1h;
+  AminoAcid aa2h;
+  pairWithHydrogen.getPair(aa1.atom[0]->resSeq,
+                           aa2.atom[0]->resSeq,
+                           aa1.residue,
+                           &aa1h,
+                           &aa2h,
+                           Anion::ligand);
+
+  if( aa2h.skip == true || aa1h.skip == true )
+    {
+      return;
+    }
+
+  float dist;
+  float distOxy;
+  float distOxy2;
+  float angleh;
+  float angleOxy;
+  float angleOxy2;
+  if(!postHydrogenGeometry<Ring>(aa1h,
+                                 aa2h,
+                                 pair.center2,
+                                 ctx.threshold,
+                                 &dist,
+                                 &distOxy,
+                                 &distOxy2,
+                                 &angleh,
+                                 &angleOxy,
+                                 &angleOxy2))
+    {
+      return;
+    }
+  float estimate = electrostaticEstimate<Ring>(ESTIMATE_ANION_CHARGE, dist, angleh);
+
+  if( !Anion::oneHydrogenAtATime )
+    {
+      writeResult<Anion>(pair, aa1h, aa2h, ctx,
+                         dist, distOxy, distOxy2, angleh, angleOxy, angleOxy2, estimate);
+      return;
+    }
+
+  // The following is pretty hackish.  For the time being since we don't
+  // have an agreement on how to deal with the PO4 ligands completely, 
+  // we will take 1 H out at a time and output the GAMESS input file.
+  // Thus, for each PO4, we will have 3 GAMESS input files.
+  // Good thing there aren't too many of these
+  int count = 0;
+  for(unsigned int i=0; i<aa2h.atom.size(); i++)
+    {
+      if( atomCode(aa2h.atom[i]->name) == HYDROGEN_CODE )
+        {
+          aa2h.atom[i]->skip = true;
+          writeResult<Anion>(pair, aa1h, aa2h, ctx,
+                             dist, distOxy, distOxy2, angleh, angleOxy, angleOxy2, estimate);
+          aa2h.atom[i]->skip = false;
+          if(count == 2) break;
+          ++count;
+        }
+    }
+}
+
+// Finds the closest pair of centers and measures it before the
+// hydrogens, then finishes it or writes it out as a candidate.
+// Everything that depends on the kind of residues is settled by Ring
+// and Anion when this is compiled
+template<class Ring, class Anion>
+static void pairKernel(AminoAcid& aa1, AminoAcid& aa2, PairContext& ctx)
+{
+  unsigned int closestDist_index1 = 0;
+  unsigned int closestDist_index2 = 0;
+
+  // Go through all combination of distances looking
+  // for the closet pair
+  float closestDist = findClosestDistance(aa1,
+                                          aa2,
+                                          ctx.threshold,
+                                          &closestDist_index1,
+                                          &closestDist_index2);
+  if( closestDist == FLT_MAX )
+    {
+      return;
+    }
+
+  // AND WE HAVE A WINNER! 
+  // Just some codes that were in the original STAAR
+  PairCandidate pair;
+  pair.code1 = 'I';
+  if( aa1.atom[0]->chainID != aa2.atom[0]->chainID )
+    pair.code1 = 'X';
+  if( ctx.contact )
+    pair.code1 = ctx.contact;
+  pair.code2 = 'S';
+  if( aa1.altLoc || aa2.altLoc )
+    {
+      pair.code2 = 'M';
+    }
+
+  // Leave out the pairs that the hydrogens cannot bring within
+  // threshold before paying for them
+  pair.aa1 = &aa1;
+  pair.aa2 = &aa2;
+  Ring::centerAtoms(aa1, closestDist_index1, pair.given1);
+  Anion::centerAtoms(aa2, closestDist_index2, pair.given2);
+  if( !reachableWithHydrogens(pair, ctx.threshold) )
+    {
+      ctx.PDBfile.hydrogens.avoided++;
+      return;
+    }
+
+  pair.closestDist = closestDist;
+  pair.center1     = aa1.center[closestDist_index1];
+  pair.center2     = aa2.center[closestDist_index2];
+
+  // The queue measures the angles of all of its pairs together
+  if( ctx.queue )
+    {
+      ctx.queue->add(pair, closestDist_index1, closestDist_index2, finishPair<Ring, Anion>, ctx);
+      return;
+    }
+
+  // calculate the angles of this interaction
+  aa1.calculateAnglesPreHydrogens(aa2,
+                                  closestDist_index1,
+                                  closestDist_index2,
+                                  &pair.angle,
+                                  &pair.angle1,
+                                  &pair.angleP);
+  if( ctx.candidates )
+    {
+      ctx.candidates->write(pair, ctx.threshold, ctx.PDBfile);
+      return;
+    }
+  finishPair<Ring, Anion>(pair, ctx);
+}
+
+PairQueue::HeldPair& PairQueue::hold(const PairCandidate& pair, PairFinisher finish, const PairContext& ctx)
+{
+  held.push_back(HeldPair());
+  HeldPair& h    = held.back();
+  h.pair         = pair;
+  h.angles       = -1;
+  h.finish       = finish;
+  h.threshold    = ctx.threshold;
+  h.PDBfile      = &ctx.PDBfile;
+  h.gamessfolder = ctx.gamessfolder;
+  h.output       = &ctx.output;
+  h.contact      = ctx.contact;
+  h.candidates   = ctx.candidates;
+  h.minEstimate  = ctx.minEstimate;
+  return h;
+}
+
+void PairQueue::add(const PairCandidate& pair, int index1, int index2, PairFinisher finish, const PairContext& ctx)
+{
+  // The planes and centers are copied into the batch now, so a moved
+  // copy can be rebuilt before the flush
+  hold(pair, finish, ctx).angles = angles.add(*pair.aa1, *pair.aa2, index1, index2);
+  if( held.size() >= PAIR_QUEUE_LIMIT )
+    {
+      flush();
+    }
+}
+
+void PairQueue::add(const PairCandidate& pair, PairFinisher finish, const PairContext& ctx)
+{
+  hold(pair, finish, ctx);
+  if( held.size() >= PAIR_QUEUE_LIMIT )
+    {
+      flush();
+    }
+}
+
+void PairQueue::flush()
+{
+  // Taken out first, so that the queue is empty while they are finished
+  vector<HeldPair> pairs;
+  pairs.swap(held);
+
+  angles.run();
+  for(unsigned int i=0; i<pairs.size(); i++)
+    {
+      if( pairs[i].angles >= 0 )
+        {
+          pairs[i].pair.angle  = angles.angle[pairs[i].angles];
+          pairs[i].pair.angle1 = angles.angle1[pairs[i].angles];
+          pairs[i].pair.angleP = angles.angleP[pairs[i].angles];
+        }
+    }
+  angles.clear();
+
+  // The residues of the pairs of each structure go to Babel together
+  // if it has workers to split them over.  The ones compared with
+  // placeHydrogens are still done one at a time
+  vector<AminoAcid*>      residues;
+  vector< vector<Atom*> > given;
+  for(unsigned int i=0; i<pairs.size(); i++)
+    {
+      if( !pairs[i].candidates )
+        {
+          residues.push_back(pairs[i].pair.aa1);
+          given.push_back(pairs[i].pair.given1);
+          residues.push_back(pairs[i].pair.aa2);
+          given.push_back(pairs[i].pair.given2);
+        }
+      HydrogenCache& cache = pairs[i].PDBfile->hydrogens;
+      if( i+1 == pairs.size() || pairs[i+1].PDBfile != pairs[i].PDBfile )
+        {
+          if( cache.pool && cache.engine == HYDROGENS_BABEL )
+            {
+              pairs[i].PDBfile->protonateAhead(residues, given, cache);
+            }
+          residues.clear();
+          given.clear();
+        }
+    }
+
+  for(unsigned int i=0; i<pairs.size(); i++)
+    {
+      HeldPair& h = pairs[i];
+      if( h.candidates )
+        {
+          h.candidates->write(h.pair, h.threshold, *h.PDBfile);
+          continue;
+        }
+      PairContext ctx(h.threshold, *h.PDBfile, h.gamessfolder, *h.output, h.contact);
+      ctx.minEstimate = h.minEstimate;
+      h.finish(h.pair, ctx);
+    }
+}
+
+// The kinds of aromatics and anions the kernels are made for
+struct AromaticName
+{
+  const char* name;
+  int         kind;
+};
+
+#define RING_BENZENE 0
+
+#define ANION_CARBOXYLATE         0
+#define ANION_PHOSPHATE           1
+#define ANION_HYDROGEN_PHOSPHATE  2
+#define ANION_PHOSPHONATE         3
+#define NUM_ANIONS                4
+
+static const AromaticName aromatics[] =
+  {
+    { "PHE", RING_BENZENE },
+    { "TYR", RING_BENZENE },
+    { NULL,  0 }
+  };
+
+static const AromaticName anions[] =
+  {
+    { "ASP", ANION_CARBOXYLATE },
+    { "GLU", ANION_CARBOXYLATE },
+    { "PO4", ANION_PHOSPHATE },
+    { "2HP", ANION_HYDROGEN_PHOSPHATE },
+    { " PI", ANION_HYDROGEN_PHOSPHATE },
+    { "2PO", ANION_PHOSPHONATE },
+    { "PO3", ANION_PHOSPHONATE },
+    { NULL,  0 }
+  };
+
+// One kernel for every ring and anion, indexed by their kinds
+static const PairKernel kernelsByKind[][NUM_ANIONS] =
+  {
+    { pairKernel<BenzeneRing, Carboxylate>,
+      pairKernel<BenzeneRing, Phosphate>,
+      pairKernel<BenzeneRing, HydrogenPhosphate>,
+      pairKernel<BenzeneRing, Phosphonate> }
+  };
+
+// And the finishers that go with them
+static const PairFinisher finishersByKind[][NUM_ANIONS] =
+  {
+    { finishPair<BenzeneRing, Carboxylate>,
+      finishPair<BenzeneRing, Phosphate>,
+      finishPair<BenzeneRing, HydrogenPhosphate>,
+      finishPair<BenzeneRing, Phosphonate> }
+  };
+
+static int findKind(const AromaticName* names, const string& name)
+{
+  for(unsigned int i=0; names[i].name; i++)
+    {
+      if( name == names[i].name )
+        {
+          return names[i].kind;
+        }
+    }
+  return -1;
+}
+
+void PairKernelTable::build(const vector<string>& residue1,
+                            const vector<string>& residue2,
+                            const vector<string>& ligands)
+{
+  names1.clear();
+  names2.clear();
+  kernels.clear();
+
+  vector<string> partners(residue2);
+  partners.insert(partners.end(), ligands.begin(), ligands.end());
+  for(unsigned int i=0; i<residue1.size(); i++)
+    {
+      int ring = findKind(aromatics, residue1[i]);
+      for(unsigned int j=0; j<partners.size(); j++)
+        {
+          int anion = findKind(anions, partners[j]);
+          if( ring < 0 || anion < 0 )
+            {
+#ifndef DISABLE_WARNING
+              cout << cyan << "WARNING" << reset << ": " << residue1[i] << " and " << partners[j]
+                   << " cannot be measured with hydrogens; their pairs are skipped" << endl;
+#endif
+              continue;
+            }
+          names1.push_back(residue1[i]);
+          names2.push_back(partners[j]);
+          kernels.push_back(kernelsByKind[ring][anion]);
+        }
+    }
+}
+
+PairKernel PairKernelTable::find(const string& residue1, const string& residue2) const
+{
+  for(unsigned int i=0; i<kernels.size(); i++)
+    {
+      if( names1[i] == residue1 && names2[i] == residue2 )
+        {
+          return kernels[i];
+        }
+    }
+  return NULL;
+}
+
+PairFinisher findPairFinisher(const string& residue1, const string& residue2)
+{
+  int ring  = findKind(aromatics, residue1);
+  int anion = findKind(anions, residue2);
+  if( ring < 0 || anion < 0 )
+    {
+      return NULL;
+    }
+  return finishersByKind[ring][anion];
+}
+
+void outputINPfile(string input_filename,
+                   char* filename,
+                   AminoAcid& aa1h,
+                   AminoAcid& aa2h,
+                   bool leaveOneOut)
+{
+  ofstream inpout(filename);
+
+  inpout << INPheader << endl;
+  inpout << " $MOROKM IATM(1)=" << aa1h.atom.size() << ",";
+  if( leaveOneOut )
+    {
+      inpout<< aa2h.atom.size() - 1 << " ICHM(1)=0,-1" << " $END" << endl;
+    }
+  else
+    {
+      inpout<< aa2h.atom.size() << " ICHM(1)=0,-1" << " $END" << endl;
+    }
+  inpout << " $DATA" << endl;
+  inpout << input_filename << endl;
+  inpout << "C1" << endl;
+  for(int i=0; i<aa1h.atom.size(); i++)
+    {
+      if( aa1h.atom[i]->element == " H" )
+        {
+          inpout << "H      1.0     ";
+        }
+      else if( aa1h.atom[i]->element == " C")
+        {
+          inpout << "C      6.0     ";
+        }
+      else if( aa1h.atom[i]->element == " O")
+        {
+          inpout << "O      8.0     ";
+        }
+      inpout << aa1h.atom[i]->coord << endl;
+    }
+
+  for(int i=0; i<aa2h.atom.size(); i++)
+    {
+      if( !aa2h.atom[i]->skip )
+        {
+          if( aa2h.atom[i]->element == " H")
+            {
+              inpout << "H      1.0     ";
+            }
+          else if( aa2h.atom[i]->element == " C")
+            {
+              inpout << "C      6.0     ";
+            }
+          else if( aa2h.atom[i]->element == " O")
+            {
+              inpout << "O      8.0     ";
+            }
+          else if( aa2h.atom[i]->element == " P")
+            {
+              inpout << "P     15.0     ";
+            }
+          inpout << aa2h.atom[i]->coord << endl;
+        }
+    }
+
+  inpout << " $END" << endl;
+  inpout.close();
+}
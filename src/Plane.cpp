@@ -0,0 +1,68 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Plane.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the Plane class
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include "Plane.hpp"
+#include "Geometry.hpp"
+
+Plane::Plane()
+{
+  offset = 0;
+  valid = false;
+}
+
+// getPlaneEquation gives a x + b y + c z = det, which only needs
+// scaling by the length of (a, b, c)
+void Plane::set(Coordinates& point1,
+                Coordinates& point2,
+                Coordinates& point3)
+{
+  Coordinates abc;
+  float det = getPlaneEquation(point1, point2, point3, &abc);
+  float length = abc.norm();
+  valid = length != 0;
+  if( !valid )
+    {
+      return;
+    }
+  normal = abc / length;
+  offset = -det / length;
+}
+
+float Plane::distance(const Coordinates& point) const
+{
+  return normal.x * point.x + normal.y * point.y + normal.z * point.z + offset;
+}
@@ -0,0 +1,158 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Query.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implementation file for the Query class
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <sstream>
+#include <algorithm>
+#include "Query.hpp"
+#include "CoutColors.hpp"
+
+Query::Query(const Options& base) : opts(base)
+{
+  opts.outputfile = NULL;
+}
+
+Query::~Query()
+{
+  if( output.is_open() )
+    {
+      output.close();
+    }
+}
+
+// The fields are: residues ligands threshold samechain outputfile
+bool Query::parse(const string& line)
+{
+  istringstream fields(line);
+  string residues, ligands, threshold, sameChain;
+  if( !(fields >> residues >> ligands >> threshold >> sameChain >> outputfile) )
+    {
+      cerr << red << "Error" << reset << ": A query needs 5 fields: residues ligands threshold samechain outputfile" << endl;
+      return false;
+    }
+  if( !opts.setResidues(residues) )
+    {
+      return false;
+    }
+  if( ligands == "-" )
+    {
+      opts.ligands.clear();
+      opts.numLigands = 0;
+    }
+  else
+    {
+      opts.setLigands(ligands);
+    }
+  if( !from_string<float>(opts.threshold, threshold, dec) )
+    {
+      cerr << red << "Error" << reset << ": Must insert a valid number for the threshold" << endl;
+      return false;
+    }
+  if( sameChain != "0" && sameChain != "1" )
+    {
+      cerr << red << "Error" << reset << ": samechain must be 0 or 1" << endl;
+      return false;
+    }
+  // -C only makes sense for the same chain
+  opts.sameChain = sameChain == "1" || opts.chain_list;
+  return true;
+}
+
+bool readQueryFile(const char* filename,
+                   const Options& base,
+                   vector<Query*>& queries)
+{
+  ifstream queryfp(filename);
+  if( !queryfp )
+    {
+      cerr << red << "Error" << reset << ": Failed to open query file, " << filename << endl;
+      perror("\t");
+      return false;
+    }
+
+  string line;
+  int count = 0;
+  while( getline(queryfp, line) )
+    {
+      count++;
+      if( line.find_first_not_of(" \t\r") == string::npos || line[line.find_first_not_of(" \t")] == '#' )
+        {
+          continue;
+        }
+      Query* q = new Query(base);
+      if( !q->parse(line) )
+        {
+          cerr << red << "Error" << reset << ": Query file line " << count << " is malformed" << endl;
+          delete q;
+          return false;
+        }
+      queries.push_back(q);
+    }
+  if( queries.empty() )
+    {
+      cerr << red << "Error" << reset << ": No queries in " << filename << endl;
+      return false;
+    }
+  return true;
+}
+
+// Adds the names of from to the end of to, skipping the ones already there
+static void addNames(const vector<string>& from, vector<string>& to)
+{
+  for(unsigned int i=0; i<from.size(); i++)
+    {
+      if( find(to.begin(), to.end(), from[i]) == to.end() )
+        {
+          to.push_back(from[i]);
+        }
+    }
+}
+
+void mergeQueries(vector<Query*>& queries, Options& opts)
+{
+  opts.residue1.clear();
+  opts.residue2.clear();
+  opts.ligands.clear();
+  opts.threshold = 0;
+  for(unsigned int i=0; i<queries.size(); i++)
+    {
+      addNames(queries[i]->opts.residue1, opts.residue1);
+      addNames(queries[i]->opts.residue2, opts.residue2);
+      addNames(queries[i]->opts.ligands,  opts.ligands);
+      opts.threshold = max(opts.threshold, queries[i]->opts.threshold);
+    }
+  opts.numLigands = opts.ligands.size();
+}
@@ -0,0 +1,255 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: ResidueTable.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Tables describing the atoms that the centers of every supported
+//               residue and ligand are made of
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <iostream>
+#include "ResidueTable.hpp"
+#include "Atom.hpp"
+#include "CoutColors.hpp"
+
+#define C(a,b,c,d) ATOM_CODE(a,b,c,d)
+
+// Indexes into descriptors below
+#define DESCRIPTOR_PHE_TYR     0
+#define DESCRIPTOR_TRP         1
+#define DESCRIPTOR_ASP         2
+#define DESCRIPTOR_GLU         3
+#define DESCRIPTOR_PHOSPHATE   4
+#define DESCRIPTOR_PHOSPHONATE 5
+#define NUM_DESCRIPTORS        6
+
+static const ResidueDescriptor descriptors[NUM_DESCRIPTORS] =
+  {
+    // PHE and TYR: the ring averaged over every conformer.  The plane is
+    // CG, CD1, CD2 and the center of charge is halfway between CD1 and CE2
+    {
+      CENTER_CONFORMERS, 6,
+      { {C(' ','C','G',' ')}, {C(' ','C','D','1')}, {C(' ','C','D','2')},
+        {C(' ','C','Z',' ')}, {C(' ','C','E','1')}, {C(' ','C','E','2')} },
+      { 1, 1, 1, 1, 1, 1 },
+      6, { 0, 1, 2, 3, 4, 5 },
+      CHARGE_WEIGHTED,
+      { 0, 1, 0, 0, 0, 1 }, 0,
+      3, { 0, 1, 5 },
+      6, { {0,2,1,-1}, {1,4,0,-1}, {2,5,0,-1}, {3,5,4,-1}, {4,1,3,-1}, {5,2,3,-1} }
+    },
+    // TRP: both rings weighted by mass, for every combination of
+    // alternate locations
+    {
+      CENTER_COMBINATIONS, 9,
+      { {C(' ','C','G',' ')}, {C(' ','C','H','2')}, {C(' ','C','D','1')},
+        {C(' ','C','D','2')}, {C(' ','N','E','1')}, {C(' ','C','E','2')},
+        {C(' ','C','E','3')}, {C(' ','C','Z','2')}, {C(' ','C','Z','3')} },
+      { MASS_C, MASS_C, MASS_C, MASS_C, MASS_N, MASS_C, MASS_C, MASS_C, MASS_C },
+      3, { 0, 2, 3 },
+      CHARGE_NONE,
+      { 0 }, 0,
+      0, { 0 },
+      9, { {0,2,3,-1}, {1,7,8,-1}, {2,0,4,-1}, {3,0,5,6,-1}, {4,2,5,-1},
+           {5,3,4,7,-1}, {6,3,8,-1}, {7,5,1,-1}, {8,6,1,-1} }
+    },
+    // ASP: each oxygen is a center.  The plane is OD1, OD2, CG
+    {
+      CENTER_ATOMS, 3,
+      { {C(' ','C','G',' ')}, {C(' ','O','D','1')}, {C(' ','O','D','2')} },
+      { 0, 1, 1 },
+      3, { 1, 2, 0 },
+      CHARGE_CARBOXYLATE,
+      { 1, 0, 0 }, 0,
+      0, { 0 },
+      3, { {0,1,2,-1}, {1,0,-1}, {2,0,-1} }
+    },
+    // GLU: the same as ASP one carbon further out
+    {
+      CENTER_ATOMS, 3,
+      { {C(' ','C','D',' ')}, {C(' ','O','E','1')}, {C(' ','O','E','2')} },
+      { 0, 1, 1 },
+      3, { 1, 2, 0 },
+      CHARGE_CARBOXYLATE,
+      { 1, 0, 0 }, 0,
+      0, { 0 },
+      3, { {0,1,2,-1}, {1,0,-1}, {2,0,-1} }
+    },
+    // PO4, 2HP, and PI: P and four oxygens weighted by mass
+    {
+      CENTER_COMBINATIONS, 5,
+      { {C(' ','P',' ',' ')}, {C(' ','O','1',' ')}, {C(' ','O','2',' ')},
+        {C(' ','O','3',' ')}, {C(' ','O','4',' ')} },
+      { MASS_P, MASS_O, MASS_O, MASS_O, MASS_O },
+      5, { 0, 1, 2, 3, 4 },
+      CHARGE_WEIGHTED,
+      { CHARGE_P, CHARGE_O, CHARGE_O, CHARGE_O, CHARGE_O }, CHARGE_H,
+      0, { 0 },
+      5, { {0,1,2,3,4,-1}, {1,0,-1}, {2,0,-1}, {3,0,-1}, {4,0,-1} }
+    },
+    // 2PO and PO3: P and three oxygens, which can also be called O1P,
+    // O2P, and O3P
+    {
+      CENTER_COMBINATIONS, 4,
+      { {C(' ','P',' ',' ')},
+        {C(' ','O','1',' '), C(' ','O','1','P')},
+        {C(' ','O','2',' '), C(' ','O','2','P')},
+        {C(' ','O','3',' '), C(' ','O','3','P')} },
+      { MASS_P, MASS_O, MASS_O, MASS_O },
+      4, { 0, 1, 2, 3 },
+      CHARGE_WEIGHTED,
+      { CHARGE_P, CHARGE_O, CHARGE_O, CHARGE_O }, CHARGE_H,
+      0, { 0 },
+      4, { {0,1,2,3,-1}, {1,0,-1}, {2,0,-1}, {3,0,-1} }
+    }
+  };
+
+static const ResidueEntry entries[] =
+  {
+    { "PHE", &descriptors[DESCRIPTOR_PHE_TYR],      2 },
+    { "TYR", &descriptors[DESCRIPTOR_PHE_TYR],      2 },
+    { "TRP", &descriptors[DESCRIPTOR_TRP],          1 },
+    { "ASP", &descriptors[DESCRIPTOR_ASP],          1 },
+    { "GLU", &descriptors[DESCRIPTOR_GLU],          1 },
+    { "PO4", &descriptors[DESCRIPTOR_PHOSPHATE],   -3 },
+    { "2HP", &descriptors[DESCRIPTOR_PHOSPHATE],   -1 },
+    { " PI", &descriptors[DESCRIPTOR_PHOSPHATE],   -2 },
+    { "2PO", &descriptors[DESCRIPTOR_PHOSPHONATE], -2 },
+    { "PO3", &descriptors[DESCRIPTOR_PHOSPHONATE], -3 },
+    { NULL,  NULL,                                  0 }
+  };
+
+#undef C
+
+// The slot lookup of each descriptor is a table of 2^SLOT_HASH_BITS
+// buckets.  A name goes in bucket (code * multiplier) >> (32 - bits),
+// and the multiplier is picked so that no two names of the descriptor
+// share a bucket.  Empty buckets have code 0, which no name packs to
+#define SLOT_HASH_BITS  5
+#define SLOT_HASH_SIZE  (1 << SLOT_HASH_BITS)
+#define SLOT_HASH_TRIES 65536
+
+class SlotHash
+{
+public:
+  unsigned int multiplier;
+  unsigned int code[SLOT_HASH_SIZE];
+  int          slot[SLOT_HASH_SIZE];
+};
+
+static SlotHash slotHashes[NUM_DESCRIPTORS];
+
+static unsigned int slotBucket(unsigned int code, unsigned int multiplier)
+{
+  return (code * multiplier) >> (32 - SLOT_HASH_BITS);
+}
+
+// Tries one multiplier for d.  Returns false if two names collide
+static bool fillSlotHash(const ResidueDescriptor& d, unsigned int multiplier, SlotHash* h)
+{
+  h->multiplier = multiplier;
+  for(unsigned int b=0; b<SLOT_HASH_SIZE; b++)
+    {
+      h->code[b] = 0;
+      h->slot[b] = -1;
+    }
+  for(unsigned int k=0; k<d.slots; k++)
+    {
+      for(unsigned int n=0; n<MAX_SLOT_NAMES && d.name[k][n]; n++)
+        {
+          unsigned int b = slotBucket(d.name[k][n], multiplier);
+          if( h->code[b] )
+            {
+              return false;
+            }
+          h->code[b] = d.name[k][n];
+          h->slot[b] = k;
+        }
+    }
+  return true;
+}
+
+static void buildSlotHashes()
+{
+  for(unsigned int i=0; i<NUM_DESCRIPTORS; i++)
+    {
+      unsigned int multiplier = 0x9E3779B1u;
+      unsigned int tries = 0;
+      while( !fillSlotHash(descriptors[i], multiplier, &slotHashes[i]) )
+        {
+          multiplier += 2;
+          if( ++tries == SLOT_HASH_TRIES )
+            {
+              cerr << red << "Error" << reset << ": could not build the atom lookup of residue table entry "
+                   << i << endl;
+              break;
+            }
+        }
+    }
+}
+
+// Builds the lookups before main() starts
+class SlotHashBuilder
+{
+public:
+  SlotHashBuilder() { buildSlotHashes(); }
+};
+
+static SlotHashBuilder slotHashBuilder;
+
+const ResidueEntry* findResidueEntry(const string& residue)
+{
+  for(unsigned int i=0; entries[i].name; i++)
+    {
+      if( residue == entries[i].name )
+        {
+          return &entries[i];
+        }
+    }
+  return NULL;
+}
+
+unsigned int atomCode(const string& name)
+{
+  if( name.size() != 4 )
+    {
+      return 0;
+    }
+  return ATOM_CODE(name[0], name[1], name[2], name[3]);
+}
+
+int findSlot(const ResidueDescriptor* d, unsigned int code)
+{
+  const SlotHash& h = slotHashes[d - descriptors];
+  unsigned int b = slotBucket(code, h.multiplier);
+  return h.code[b] == code && code ? h.slot[b] : -1;
+}
@@ -0,0 +1,134 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: SpaceCurve.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Morton and Hilbert keys of points in space
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+
+
+#include <cfloat>
+#include <algorithm>
+#include "SpaceCurve.hpp"
+
+// Moves the low CURVE_BITS bits of v to every third bit
+static unsigned int spreadBits(unsigned int v)
+{
+  v &= 0x3FF;
+  v = (v | (v << 16)) & 0x030000FF;
+  v = (v | (v <<  8)) & 0x0300F00F;
+  v = (v | (v <<  4)) & 0x030C30C3;
+  v = (v | (v <<  2)) & 0x09249249;
+  return v;
+}
+
+unsigned int mortonKey(unsigned int x, unsigned int y, unsigned int z)
+{
+  return (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+}
+
+// Skilling's transform ("Programming the Hilbert curve", 2004): the
+// coordinates are turned in place into the transposed Hilbert index,
+// whose bits are then interleaved like a Morton key
+unsigned int hilbertKey(unsigned int x, unsigned int y, unsigned int z)
+{
+  unsigned int X[3] = { x, y, z };
+
+  // Inverse undo
+  for(unsigned int Q = 1u << (CURVE_BITS - 1); Q > 1; Q >>= 1)
+    {
+      unsigned int P = Q - 1;
+      for(int i=0; i<3; i++)
+        {
+          if( X[i] & Q )
+            {
+              X[0] ^= P;
+            }
+          else
+            {
+              unsigned int t = (X[0] ^ X[i]) & P;
+              X[0] ^= t;
+              X[i] ^= t;
+            }
+        }
+    }
+
+  // Gray encode
+  X[1] ^= X[0];
+  X[2] ^= X[1];
+  unsigned int t = 0;
+  for(unsigned int Q = 1u << (CURVE_BITS - 1); Q > 1; Q >>= 1)
+    {
+      if( X[2] & Q )
+        {
+          t ^= Q - 1;
+        }
+    }
+  X[0] ^= t;
+  X[1] ^= t;
+  X[2] ^= t;
+
+  return mortonKey(X[0], X[1], X[2]);
+}
+
+void curveKeys(const vector<Coordinates>& points, int curve, vector<unsigned int>& keys)
+{
+  keys.assign(points.size(), 0);
+  if( curve == ORDER_SEQUENCE || points.empty() )
+    {
+      return;
+    }
+
+  Coordinates lower( FLT_MAX,  FLT_MAX,  FLT_MAX);
+  Coordinates upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  for(unsigned int i=0; i<points.size(); i++)
+    {
+      lower.x = min(lower.x, points[i].x);
+      lower.y = min(lower.y, points[i].y);
+      lower.z = min(lower.z, points[i].z);
+      upper.x = max(upper.x, points[i].x);
+      upper.y = max(upper.y, points[i].y);
+      upper.z = max(upper.z, points[i].z);
+    }
+
+  // The same scale on every axis so that the cells stay cubes
+  float edge = max(upper.x - lower.x, max(upper.y - lower.y, upper.z - lower.z));
+  float scale = edge > 0 ? ((1 << CURVE_BITS) - 1) / edge : 0;
+  for(unsigned int i=0; i<points.size(); i++)
+    {
+      unsigned int x = (unsigned int)((points[i].x - lower.x) * scale);
+      unsigned int y = (unsigned int)((points[i].y - lower.y) * scale);
+      unsigned int z = (unsigned int)((points[i].z - lower.z) * scale);
+      keys[i] = curve == ORDER_HILBERT ? hilbertKey(x, y, z) : mortonKey(x, y, z);
+    }
+}
@@ -0,0 +1,397 @@
+/****************************************************************************************************/
+//  COPYRIGHT 2026, University of Tennessee
+//  Author: agent (agent@local)
+//  File: Symmetry.cpp
+//  Date: 18 Oct 2026
+//  Version: 1.0
+//  Description: Implements the rigid-body operators and unit cell used to look at
+//               crystal contacts and biological assemblies without having to store
+//               copies of the whole structure
+//
+/***************************************************************************************************/
+//
+/***************************************************************************************************/
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  Redistributions of source code must retain the above copyright notice,
+//  this list of conditions and the following disclaimer.
+//  Redistributions in binary form must reproduce the above copyright notice,
+//  this list of conditions and the following disclaimer in the documentation
+//  and/or other materials provided with the distribution.
+//  Neither the name of the University of Tennessee nor the names of its contributors
+//  may be used to endorse or promote products derived from this software
+//  without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+//  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS
+//  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+//  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+//  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*************************************************************************************************/
+
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include "Symmetry.hpp"
+#include "Utils.hpp"
+#include "CoutColors.hpp"
+
+#define DEG_TO_RAD (3.14159265358979/180.0)
+
+// Inverts a 3x3 matrix using its adjugate. Returns false if the
+// matrix is singular
+static bool invert3(const float m[3][3], float inv[3][3])
+{
+  double det = m[0][0] * ( m[1][1]*m[2][2] - m[1][2]*m[2][1] ) -
+               m[0][1] * ( m[1][0]*m[2][2] - m[1][2]*m[2][0] ) +
+               m[0][2] * ( m[1][0]*m[2][1] - m[1][1]*m[2][0] );
+  if( det == 0 )
+    {
+      return false;
+    }
+  inv[0][0] =  ( m[1][1]*m[2][2] - m[1][2]*m[2][1] ) / det;
+  inv[0][1] = -( m[0][1]*m[2][2] - m[0][2]*m[2][1] ) / det;
+  inv[0][2] =  ( m[0][1]*m[1][2] - m[0][2]*m[1][1] ) / det;
+  inv[1][0] = -( m[1][0]*m[2][2] - m[1][2]*m[2][0] ) / det;
+  inv[1][1] =  ( m[0][0]*m[2][2] - m[0][2]*m[2][0] ) / det;
+  inv[1][2] = -( m[0][0]*m[1][2] - m[0][2]*m[1][0] ) / det;
+  inv[2][0] =  ( m[1][0]*m[2][1] - m[1][1]*m[2][0] ) / det;
+  inv[2][1] = -( m[0][0]*m[2][1] - m[0][1]*m[2][0] ) / det;
+  inv[2][2] =  ( m[0][0]*m[1][1] - m[0][1]*m[1][0] ) / det;
+  return true;
+}
+
+// Multiplies a 3x3 matrix with a point
+static Coordinates multiply3(const float m[3][3], const Coordinates& p)
+{
+  return Coordinates( m[0][0]*p.x + m[0][1]*p.y + m[0][2]*p.z,
+                      m[1][0]*p.x + m[1][1]*p.y + m[1][2]*p.z,
+                      m[2][0]*p.x + m[2][1]*p.y + m[2][2]*p.z );
+}
+
+// Start off as the identity
+Transform::Transform()
+{
+  for(int i=0; i<3; i++)
+    {
+      for(int j=0; j<3; j++)
+        {
+          r[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+      t[i] = 0.0;
+    }
+  serial = 0;
+}
+
+Coordinates Transform::apply(const Coordinates& p) const
+{
+  Coordinates result = multiply3(r, p);
+  result.x += t[0];
+  result.y += t[1];
+  result.z += t[2];
+  return result;
+}
+
+// x = R^-1 (x' - t)
+Transform Transform::inverse() const
+{
+  Transform inv;
+  if( !invert3(r, inv.r) )
+    {
+      cerr << red << "Error" << reset << ": Operator " << serial << " can not be inverted" << endl;
+      return inv;
+    }
+  for(int i=0; i<3; i++)
+    {
+      inv.t[i] = -( inv.r[i][0]*t[0] + inv.r[i][1]*t[1] + inv.r[i][2]*t[2] );
+    }
+  inv.serial = serial;
+  return inv;
+}
+
+Transform Transform::operator*(const Transform& rhs) const
+{
+  Transform result;
+  for(int i=0; i<3; i++)
+    {
+      for(int j=0; j<3; j++)
+        {
+          result.r[i][j] = r[i][0]*rhs.r[0][j] + r[i][1]*rhs.r[1][j] + r[i][2]*rhs.r[2][j];
+        }
+      result.t[i] = r[i][0]*rhs.t[0] + r[i][1]*rhs.t[1] + r[i][2]*rhs.t[2] + t[i];
+    }
+  result.serial = serial;
+  return result;
+}
+
+bool Transform::isIdentity() const
+{
+  Transform identity;
+  return equals(identity);
+}
+
+bool Transform::equals(const Transform& rhs) const
+{
+  for(int i=0; i<3; i++)
+    {
+      for(int j=0; j<3; j++)
+        {
+          if( fabs(r[i][j] - rhs.r[i][j]) > TRANSFORM_TOLERANCE )
+            {
+              return false;
+            }
+        }
+      // The translations are in Angstroms so they get a looser check
+      if( fabs(t[i] - rhs.t[i]) > TRANSFORM_TOLERANCE * 100 )
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+UnitCell::UnitCell()
+{
+  valid = false;
+  a = b = c = 0;
+  alpha = beta = gamma = 90;
+  spaceGroup = "";
+  for(int i=0; i<3; i++)
+    {
+      for(int j=0; j<3; j++)
+        {
+          orth[i][j] = frac[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+}
+
+// CRYST1 columns are:
+//   a: 7-15, b: 16-24, c: 25-33, alpha: 34-40, beta: 41-47, gamma: 48-54,
+//   space group: 56-66
+bool UnitCell::parseCRYST1(const string& line)
+{
+  valid = false;
+  if( line.length() < 54 ||
+      !from_string<float>(a,     line.substr(6,9),  dec) ||
+      !from_string<float>(b,     line.substr(15,9), dec) ||
+      !from_string<float>(c,     line.substr(24,9), dec) ||
+      !from_string<float>(alpha, line.substr(33,7), dec) ||
+      !from_string<float>(beta,  line.substr(40,7), dec) ||
+      !from_string<float>(gamma, line.substr(47,7), dec) )
+    {
+      return false;
+    }
+  if( line.length() > 55 )
+    {
+      spaceGroup = line.substr(55, 11);
+    }
+
+  // NMR and EM entries carry a 1x1x1 placeholder cell
+  if( a <= 1.0 || b <= 1.0 || c <= 1.0 )
+    {
+      return true;
+    }
+
+  // The standard PDB orthogonalisation: a along x and b in the xy plane
+  double ca = cos(alpha * DEG_TO_RAD);
+  double cb = cos(beta  * DEG_TO_RAD);
+  double cg = cos(gamma * DEG_TO_RAD);
+  double sg = sin(gamma * DEG_TO_RAD);
+  double volume = a * b * c * sqrt(1 - ca*ca - cb*cb - cg*cg + 2*ca*cb*cg);
+
+  orth[0][0] = a;  orth[0][1] = b * cg;  orth[0][2] = c * cb;
+  orth[1][0] = 0;  orth[1][1] = b * sg;  orth[1][2] = c * (ca - cb*cg) / sg;
+  orth[2][0] = 0;  orth[2][1] = 0;       orth[2][2] = volume / (a * b * sg);
+
+  valid = invert3(orth, frac);
+  return true;
+}
+
+Coordinates UnitCell::toFractional(const Coordinates& p) const
+{
+  return multiply3(frac, p);
+}
+
+Coordinates UnitCell::toOrthogonal(const Coordinates& p) const
+{
+  return multiply3(orth, p);
+}
+
+Transform UnitCell::latticeShift(int na, int nb, int nc) const
+{
+  Transform shift;
+  Coordinates t = toOrthogonal(Coordinates(na, nb, nc));
+  shift.t[0] = t.x;
+  shift.t[1] = t.y;
+  shift.t[2] = t.z;
+  return shift;
+}
+
+// Row i of the fractionalisation matrix maps a displacement onto
+// fractional axis i, so a sphere of radius r covers r*|row i| along it
+void UnitCell::fractionalReach(float r, float reach[3]) const
+{
+  for(int i=0; i<3; i++)
+    {
+      reach[i] = r * sqrt( frac[i][0]*frac[i][0] +
+                           frac[i][1]*frac[i][1] +
+                           frac[i][2]*frac[i][2] );
+    }
+}
+
+// The rows look like:
+// REMARK 290     SMTRY1   2 -1.000000  0.000000  0.000000        0.00000
+// REMARK 350   BIOMT1   1  1.000000  0.000000  0.000000        0.00000
+bool parseOperatorRow(const string& line, const char* tag, vector<Transform>& ops)
+{
+  size_t found = line.find(tag);
+  if( found == string::npos )
+    {
+      return false;
+    }
+  found += strlen(tag);
+
+  int row = line[found] - '1';
+  if( row < 0 || row > 2 )
+    {
+      return false;
+    }
+
+  istringstream fields(line.substr(found+1));
+  int serial;
+  float m[4];
+  if( !(fields >> serial >> m[0] >> m[1] >> m[2] >> m[3]) )
+    {
+      return false;
+    }
+
+  // Rows of the same operator are always consecutive, but be
+  // forgiving and look the serial number up anyway
+  int index = ops.size() - 1;
+  while( index >= 0 && ops[index].serial != serial )
+    {
+      index--;
+    }
+  if( index < 0 )
+    {
+      ops.push_back(Transform());
+      index = ops.size() - 1;
+      ops[index].serial = serial;
+    }
+
+  ops[index].r[row][0] = m[0];
+  ops[index].r[row][1] = m[1];
+  ops[index].r[row][2] = m[2];
+  ops[index].t[row]    = m[3];
+  return true;
+}
+
+// Adds the comma separated chain identifiers after the colon of line
+static bool appendChains(const string& line, string& chains)
+{
+  size_t found = line.find(':');
+  if( found == string::npos )
+    {
+      return false;
+    }
+  vector<string> ids = split(line.substr(found+1), ',');
+  for(unsigned int i=0; i<ids.size(); i++)
+    {
+      for(unsigned int j=0; j<ids[i].size(); j++)
+        {
+          if( ids[i][j] != ' ' && chains.find(ids[i][j]) == string::npos )
+            {
+              chains += ids[i][j];
+            }
+        }
+    }
+  return true;
+}
+
+bool parseAssemblyLine(const string& line, vector<Biomolecule>& assemblies)
+{
+  size_t found;
+  if( (found = line.find("BIOMOLECULE:")) != string::npos )
+    {
+      Biomolecule b;
+      if( !from_string<int>(b.number, line.substr(found+12), std::dec) )
+        {
+          return false;
+        }
+      assemblies.push_back(b);
+      return true;
+    }
+
+  // Everything else needs a biomolecule to belong to
+  if( line.find("APPLY THE FOLLOWING TO CHAINS:") != string::npos )
+    {
+      if( assemblies.empty() )
+        {
+          return false;
+        }
+      assemblies.back().groups.push_back(AssemblyGroup());
+      return appendChains(line, assemblies.back().groups.back().chains);
+    }
+  if( line.find("AND CHAINS:") != string::npos )
+    {
+      if( assemblies.empty() || assemblies.back().groups.empty() )
+        {
+          return false;
+        }
+      return appendChains(line, assemblies.back().groups.back().chains);
+    }
+  if( line.find("BIOMT") != string::npos )
+    {
+      if( assemblies.empty() || assemblies.back().groups.empty() )
+        {
+          return false;
+        }
+      return parseOperatorRow(line, "BIOMT", assemblies.back().groups.back().ops);
+    }
+  return true;
+}
+
+void makeImageResidue(Residue& r,
+                      const Transform& op,
+                      vector<Atom>& storage,
+                      Residue* image)
+{
+  vector<char> altloc_ids;
+
+  // Reserve first so that the pointers handed out below stay valid
+  storage.clear();
+  storage.reserve(r.atom.size());
+
+  image->atom.clear();
+  image->altlocIds.clear();
+  image->center.clear();
+  for(unsigned int i=0; i<r.atom.size(); i++)
+    {
+      storage.push_back(*r.atom[i]);
+      storage.back().setCoordinates(op.apply(r.atom[i]->coord));
+      image->atom.push_back(&storage.back());
+      if( r.atom[i]->altLoc != ' ' &&
+          find(altloc_ids.begin(), altloc_ids.end(), r.atom[i]->altLoc) == altloc_ids.end() )
+        {
+          altloc_ids.push_back(r.atom[i]->altLoc);
+        }
+    }
+
+  image->residue = r.residue;
+  image->skip    = false;
+  image->altLoc  = false;
+  image->determineAltLoc(altloc_ids);
+  image->calculateCenter(false);
+}
@@ -51,25 +51,115 @@
 #include "Geometry.hpp"
 #include "AminoAcid.hpp"
 #include "Coordinates.hpp"
+#include "Symmetry.hpp"
+#include "NeighborGrid.hpp"
+#include "Distance.hpp"
+#include "Angles.hpp"
+#include "Query.hpp"
+#include "PairKernels.hpp"
+#include "HydrogenPlacer.hpp"
+#include "BabelPool.hpp"
+#include "CandidateFile.hpp"
 #include "CoutColors.hpp"
 
 #define MAX_STR_LENGTH 1024
 
-// Parses through a single PDB file checking for interactions
+// Parses through a single PDB file checking for interactions.  The
+// file is read once with opts and then searched for every query
 bool processSinglePDBFile(const char* filename,
                           Options& opts,
-                          ofstream& output_file,
+                          vector<Query*>& queries,
                           const char* chains=NULL);
 
 // Read PDB names from a list and parses them from the specified directory
-bool processPDBList(Options& opts);
+bool processPDBList(Options& opts, vector<Query*>& queries);
 
 // Reads the PDB names and chains from a list and parses them from the
 // specified directory
-bool processPDBChainList(Options& opts);
+bool processPDBChainList(Options& opts, vector<Query*>& queries);
 
 // Traverses through a directory of PDB files processing each one
-bool processPDBDirectory(Options& opts);
+bool processPDBDirectory(Options& opts, vector<Query*>& queries);
+
+// Adds the hydrogens to the pairs of the candidate file written by an
+// earlier --write-candidates run, or to those of one shard of it
+bool processCandidateFile(Options& opts, vector<Query*>& queries);
+
+// A residue2 type residue or ligand that came within reach of one of
+// the residue1 type residues
+class Candidate
+{
+public:
+  unsigned int chain;           // Chain index of the partner (ligand index for ligands)
+  unsigned int index;           // Index of the partner in the chain
+  bool         ligand;          // True if the partner is PDB::ligands[chain]
+  float        distance;        // Closest distance between the centers
+
+  // Orders the partners the same way the chains are walked through
+  bool operator<(const Candidate& rhs) const
+  {
+    if( ligand != rhs.ligand ) return !ligand;
+    if( chain  != rhs.chain  ) return chain < rhs.chain;
+    return index < rhs.index;
+  }
+};
+
+// candidates[i][j] holds the partners of PDB::chains[i].aa[j]
+typedef vector< vector< vector<Candidate> > > CandidateList;
+
+// Finds the partners of every residue1 type residue that come within
+// opts.threshold.  With several queries opts holds the largest threshold
+// so that the same list serves all of them
+void findCandidates(PDB & PDBfile,
+                    Options & opts,
+                    CandidateList& candidates);
+
+// Finds the pairs whose representative atoms say that they may have
+// centers within reach of each other.  No centers are calculated
+void findNearPairs(PDB & PDBfile,
+                   Options & opts,
+                   float reach,
+                   CandidateList& near);
+
+// Calculates the centers of the near pairs and keeps the ones within
+// opts.threshold
+void checkNearPairs(PDB & PDBfile,
+                    Options & opts,
+                    CandidateList& near,
+                    CandidateList& candidates);
+
+// Near pairs found at threshold + skin, kept from one model of an
+// ensemble to the next along with where the residues were at the time
+class VerletList
+{
+public:
+  // Constructor that starts off with no list
+  VerletList();
+
+  CandidateList       pairs;     // Pairs within threshold + skin
+  vector<Coordinates> reference; // Representative atoms when the list was built
+  vector<float>       pads;      // ...and their paddings
+  vector<string>      names;     // Residue names, to make sure the models match
+  vector<int>         resSeqs;   // ...and residue numbers
+  float               skin;      // Extra distance the list was built with
+  bool                valid;     // False until the list has been built
+  unsigned int        rebuilds;  // Number of times the list was built
+  unsigned int        reuses;    // Number of models that reused it
+};
+
+// Same as findCandidates, but reuses the near pairs of the Verlet list
+// as long as the residues have not moved too much since it was built
+void findCandidatesVerlet(PDB & PDBfile,
+                          Options & opts,
+                          VerletList& verlet,
+                          CandidateList& candidates);
+
+// Runs the search of a single query over the candidate pairs
+void searchQuery(PDB & PDBfile,
+                 Options & opts,
+                 ofstream& output_file,
+                 CandidateList& candidates,
+                 const char* chains);
 
 // Searches through all of the chains looking for interactions
 void searchChainInformation(PDB & PDBfile,
@@ -78,41 +168,64 @@ void searchChainInformation(PDB & PDBfile,
                             string residue1,
                             string residue2,
                             Options & opts,
-                            ofstream& output_file);
+                            ofstream& output_file,
+                            CandidateList& candidates);
 
 void searchLigandsInformation(PDB & PDBfile,
-                              Residue & ligand,
+                              unsigned int ligand,
                               unsigned int chain1,
                               string residue1,
                               Options & opts,
-                              ofstream& output_file);
-
-// Finds the closest distance among all of the centers
-// associated with each amino acid
-double findClosestDistance(AminoAcid& aa1,
-                           AminoAcid& aa2,
-                           float threshold,
-                           unsigned int* closest_index1,
-                           unsigned int* closest_index2);
+                              ofstream& output_file,
+                              CandidateList& candidates);
+
+// Returns the index of name in list, or -1 if it isn't there
+static int findResidueName(vector<string>* list, string& name);
+
+// Searches between the asymmetric unit and the images made by the
+// crystal symmetry operators
+void searchCrystalContacts(PDB & PDBfile,
+                           Options & opts,
+                           ofstream& output_file,
+                           const char* chains);
+
+// Searches between the chain copies of the biological assembly
+// picked with --assembly
+void searchAssemblyInterfaces(PDB & PDBfile,
+                              Options & opts,
+                              ofstream& output_file,
+                              const char* chains);
 
 // Finds the closest interaction among all of the possible
-// amino acid centers
+// amino acid centers.  contact is the code written instead of
+// I/X when aa2 is a moved copy: C for a crystal symmetry mate
+// and B for another chain copy of the biological assembly
 void findBestInteraction( AminoAcid& aa1,
                           AminoAcid& aa2,
                           float threshold,
                           PDB& PDBfile,
                           char* gamessfolder,
-                          bool ligand,
-                          ofstream& output_file);
-
-// Writes the INP files
-void outputINPfile(string input_filename,
-                   char* filename,
-                   AminoAcid& aa1h,
-                   AminoAcid& aa2h);
+                          ofstream& output_file,
+                          char contact=0);
 
 void write_output_head(ofstream& out);
 
+// The pair kernel for every residue and anion pairing searched for
+static PairKernelTable pairKernels;
+
+// The worker processes Babel runs in with --workers
+static BabelPool babelPool;
+
+// Where the pairs go with --write-candidates instead of being finished
+static CandidateWriter candidateWriter;
+
+// Where the pairs wait to be measured and protonated in batches (see
+// PairQueue)
+static PairQueue pairQueue;
+
+// Pairs the classical estimate binds by less get no GAMESS input (--min-estimate)
+static float minEstimate = 0;
+
 int main(int argc, char* argv[]){
   printHeader();
   int return_value;
@@ -128,49 +241,164 @@ int main(int argc, char* argv[]){
       return 1;
     }
 
+  setFixedPointDistances(opts.fixedPoint);
+
+  // Start the Babel workers before anything is read in, so that they
+  // are forked while the process is still small
+  if( opts.workers > 0 && opts.hydrogens != HYDROGENS_NATIVE && !opts.candidatesOut )
+    {
+      if( !babelPool.start(opts.workers, opts.workerTimeout) )
+        {
+          cerr << red << "Error" << reset << ": could not start the Babel workers!" << endl;
+          return 1;
+        }
+    }
+
+  // The searches to run.  Either the ones from the query file, in
+  // which case the structures are read with everything that any of
+  // them needs, or just the one from the command line
+  vector<Query*> queries;
+  if( opts.queryfile )
+    {
+      if( !readQueryFile(opts.queryfile, opts, queries) )
+        {
+          for(unsigned int i=0; i<queries.size(); i++) delete queries[i];
+          return 1;
+        }
+      mergeQueries(queries, opts);
+    }
+  else
+    {
+      queries.push_back(new Query(opts));
+      queries[0]->outputfile = opts.outputfile ? opts.outputfile : "";
+    }
+  pairKernels.build(opts.residue1, opts.residue2, opts.ligands);
+  minEstimate = opts.minEstimate;
+  if( opts.candidatesOut && !candidateWriter.open(opts.candidatesOut) )
+    {
+      cerr << red << "Error" << reset << ": Failed to open candidate file," << opts.candidatesOut << endl;
+      for(unsigned int j=0; j<queries.size(); j++) delete queries[j];
+      return 1;
+    }
+  for(unsigned int i=0; i<queries.size(); i++)
+    {
+      // Writing the candidates out leaves nothing for the results file
+      if( queries[i]->outputfile.empty() )
+        {
+          continue;
+        }
+      queries[i]->output.open(queries[i]->outputfile.c_str());
+      if( !queries[i]->output )
+        {
+          cerr << red << "Error" << reset << ": Failed to open output file," << queries[i]->outputfile << endl;
+          for(unsigned int j=0; j<queries.size(); j++) delete queries[j];
+          return 1;
+        }
+      write_output_head(queries[i]->output);
+    }
+
   // Lets check to see what kind of input we received for the
   // PDB file.  If we have a list file of PDBs, just go through
   // list with the specified directory. If a directory, parse 
   // all files in the directory. Otherwise just parse the single 
   // file
-  if( opts.pdblist )
+  if( opts.candidatesIn )
+    {
+      return_value = processCandidateFile(opts, queries);
+    }
+  else if( opts.pdblist )
     {
-      return_value = processPDBList(opts);
+      return_value = processPDBList(opts, queries);
     }
   else if( opts.chain_list )
     {
-      return_value = processPDBChainList(opts);
+      return_value = processPDBChainList(opts, queries);
     }
   else if( isDirectory(opts.pdbfile) )
     {
       // go through each file in the directory
-      return_value = processPDBDirectory(opts);
+      return_value = processPDBDirectory(opts, queries);
     }
   else
     {
-      ofstream output_file(opts.outputfile);
-      if(!output_file)
+      return_value = processSinglePDBFile(opts.pdbfile, opts, queries);
+    }
+
+  for(unsigned int i=0; i<queries.size(); i++)
+    {
+      delete queries[i];
+    }
+
+  if( candidateWriter.isOpen() )
+    {
+      if( !candidateWriter.close() )
         {
-          cerr << red << "Error" << reset << ": Failed to open output file," << opts.outputfile << endl;
-          return 1;
+          cerr << red << "Error" << reset << ": Failed to write candidate file," << opts.candidatesOut << endl;
+          return_value = false;
         }
-      write_output_head(output_file);
-      return_value = processSinglePDBFile(opts.pdbfile, opts, output_file);
-      output_file.close();
+      cout << gray << "Note" << reset << ": " << candidateWriter.pairs << " candidate pairs from "
+           << candidateWriter.structures << " models written to " << opts.candidatesOut << endl;
+    }
+  // Babel is only loaded once a pair needs it, in this process or in
+  // each of the workers
+  if( babelLoadTime() >= 0 )
+    {
+      cout << gray << "Note" << reset << ": Babel took " << babelLoadTime() << "s to load" << endl;
+    }
+  if( babelPool.loads > 0 )
+    {
+      cout << gray << "Note" << reset << ": Babel took " << babelPool.loadTime << "s to load in "
+           << babelPool.loads << " workers" << endl;
+    }
+  if( babelPool.restarts > 0 )
+    {
+      cout << gray << "Note" << reset << ": " << babelPool.restarts << " Babel workers crashed, hung, or exited and were restarted" << endl;
+    }
+  babelPool.stop();
+  if( gamessHeldBack() > 0 )
+    {
+      cout << gray << "Note" << reset << ": " << gamessHeldBack() << " pairs had an estimate above -"
+           << opts.minEstimate << " kcal/mol and got no GAMESS input" << endl;
     }
 
+#ifdef DEBUG
+  cout << purple << "Distance kernel: " << distanceKernelName() << endl;
+  cout << purple << "Angle kernel: " << angleKernelName() << endl;
+#endif
   cout << "Time taken: " << getTime() - start << "s" << endl;
   return !return_value;
 }
 
+// Prints how the hydrogens were placed, from the counts of totals
+static void printHydrogenNotes(const HydrogenCache& totals)
+{
+  if( totals.hits + totals.misses > 0 )
+    {
+      cout << gray << "Note" << reset << ": hydrogens placed on " << totals.misses << " residues and reused "
+           << totals.hits << " times (" << 100.0 * totals.hits / (totals.hits + totals.misses)
+           << "% of lookups)" << endl;
+    }
+  if( totals.preloaded > 0 )
+    {
+      cout << gray << "Note" << reset << ": " << totals.preloaded << " residues protonated ahead of the pairs that need them" << endl;
+    }
+  if( totals.avoided > 0 )
+    {
+      cout << gray << "Note" << reset << ": " << totals.avoided << " pairs were too far apart to need hydrogens" << endl;
+    }
+  if( totals.compared > 0 )
+    {
+      cout << gray << "Note" << reset << ": native hydrogens differ from Babel's by more than "
+           << HYDROGEN_TOLERANCE << "A (or in number) on " << totals.disagreed << " of "
+           << totals.compared << " residues; the others are at most " << totals.worst << "A apart" << endl;
+    }
+}
+
 bool processSinglePDBFile(const char* filename,
                           Options& opts,
-                          ofstream& output_file,
+                          vector<Query*>& queries,
                           const char* chains)
 {
-  int numRes1 = opts.residue1.size();
-  int numRes2 = opts.residue2.size();
-
   // Read in the PDB file
   // This function actually reads and stores more information than
   // we really need, but the files are relatively small so it isn't
@@ -185,85 +413,160 @@ bool processSinglePDBFile(const char* filename,
       return false;
     }
 
+  // Used when the models of an ensemble share their near pairs
+  VerletList verlet;
+  verlet.skin = opts.verletSkin;
+
+  // How often the hydrogens of a residue were reused by another pair
+  HydrogenCache hydrogenTotals;
+
   for(unsigned int model=0; model < PDBfile_whole.models.size(); model++)
     {
       PDB PDBfile = PDBfile_whole.models[model];
       PDBfile.filename = PDBfile_whole.filename;
       PDBfile.resolution = PDBfile_whole.resolution;
+      PDBfile.cell = PDBfile_whole.cell;
+      PDBfile.symmetry = PDBfile_whole.symmetry;
+      PDBfile.assemblies = PDBfile_whole.assemblies;
 
       PDBfile.setResiduesToFind(&opts.residue1, &opts.residue2);
+      PDBfile.setConformer(opts.conformer);
       if(opts.numLigands)
         {
           PDBfile.setLigandsToFind(&opts.ligands);
         }
-      PDBfile.populateChains(false);
+      PDBfile.populateChains(false, true);
 
       if( opts.numLigands )
         {
           PDBfile.findLigands( opts.ligands );
         }
+      PDBfile.orderResidues(opts.order);
+      PDBfile.hydrogens.engine = opts.hydrogens;
+      PDBfile.hydrogens.pool   = babelPool.size() ? &babelPool : NULL;
 
-      // Searching for interations within each chain
-      for(unsigned int i = 0; i < PDBfile.chains.size(); i++)
+      // One Babel call for the whole model instead of one per residue
+      if( opts.protonate == PROTONATE_MODEL && opts.hydrogens != HYDROGENS_NATIVE && !opts.candidatesOut )
         {
-          // Check if we are supposed to look at certain chains
-          if( chains )
-            {
-              if( !strchr(chains,PDBfile.chains[i].id) )
-                {
-                  continue;
-                }
-            }
-          // if we want to look for interactions between the ith chain
-          // and each of the other chains, we set the indices to loop
-          // though all the chains
-          unsigned int start = 0;
-          unsigned int end   = PDBfile.chains.size();
-
-          // otherwise we just set the indices to go through the ith chain
-          if(opts.sameChain)
+          PDBfile.protonateModel(PDBfile.hydrogens);
+        }
+
+      // Every pair that comes within the largest threshold, shared
+      // by all of the queries
+      CandidateList candidates;
+      if( opts.verletSkin > 0 )
+        {
+          findCandidatesVerlet(PDBfile, opts, verlet, candidates);
+        }
+      else
+        {
+          findCandidates(PDBfile, opts, candidates);
+        }
+
+      for(unsigned int q=0; q<queries.size(); q++)
+        {
+          searchQuery(PDBfile, queries[q]->opts, queries[q]->output, candidates, chains);
+        }
+      pairQueue.flush();
+      hydrogenTotals.tally(PDBfile.hydrogens);
+    }
+  printHydrogenNotes(hydrogenTotals);
+
+  if( opts.verletSkin > 0 && PDBfile_whole.models.size() > 1 )
+    {
+      cout << gray << "Note" << reset << ": Verlet list built " << verlet.rebuilds << " times and reused for "
+           << verlet.reuses << " of " << PDBfile_whole.models.size() << " models" << endl;
+    }
+  return true;
+}
+
+void searchQuery(PDB & PDBfile,
+                 Options & opts,
+                 ofstream& output_file,
+                 CandidateList& candidates,
+                 const char* chains)
+{
+  int numRes1 = opts.residue1.size();
+  int numRes2 = opts.residue2.size();
+
+  // Searching for interations within each chain
+  for(unsigned int i = 0; i < PDBfile.chains.size(); i++)
+    {
+      // Check if we are supposed to look at certain chains
+      if( chains )
+        {
+          if( !strchr(chains,PDBfile.chains[i].id) )
             {
-              start = i;
-              end   = i+1;
+              continue;
             }
+        }
+      // if we want to look for interactions between the ith chain
+      // and each of the other chains, we set the indices to loop
+      // though all the chains
+      unsigned int start = 0;
+      unsigned int end   = PDBfile.chains.size();
+
+      // otherwise we just set the indices to go through the ith chain
+      if(opts.sameChain)
+        {
+          start = i;
+          end   = i+1;
+        }
 
-          for(unsigned int j = start; j < end; j++)
+      for(unsigned int j = start; j < end; j++)
+        {
+          for(int ii = 0; ii < numRes1; ii++)
             {
-              for(int ii = 0; ii < numRes1; ii++)
+              for(int jj = 0; jj < numRes2; jj++)
                 {
-                  for(int jj = 0; jj < numRes2; jj++)
-                    {
-                      // Search for different residue combinations
-                      searchChainInformation(PDBfile,
-                                             i,
-                                             j,
-                                             opts.residue1[ii],
-                                             opts.residue2[jj],
-                                             opts,
-                                             output_file);
-                    }
+                  // Search for different residue combinations
+                  searchChainInformation(PDBfile,
+                                         i,
+                                         j,
+                                         opts.residue1[ii],
+                                         opts.residue2[jj],
+                                         opts,
+                                         output_file,
+                                         candidates);
                 }
             }
-      
-          // Go through the ligands, if there are any
-          for(unsigned int j = 0; j<PDBfile.ligands.size(); j++)
+        }
+
+      // Go through the ligands, if there are any
+      for(unsigned int j = 0; j<PDBfile.ligands.size(); j++)
+        {
+          // The structure was read with the ligands of every query
+          if( findResidueName(&opts.ligands, PDBfile.ligands[j]->residue) < 0 )
             {
-              for(int ii=0; ii<numRes1; ii++)
-                {
-                  searchLigandsInformation(PDBfile,
-                                           *PDBfile.ligands[j],
-                                           i,
-                                           opts.residue1[ii],
-                                           opts,
-                                           output_file);
-                }
+              continue;
+            }
+          for(int ii=0; ii<numRes1; ii++)
+            {
+              searchLigandsInformation(PDBfile,
+                                       j,
+                                       i,
+                                       opts.residue1[ii],
+                                       opts,
+                                       output_file,
+                                       candidates);
             }
         }
     }
-  return true;
+
+  // And now look at the contacts with the symmetry mates
+  if( opts.crystalContacts )
+    {
+      searchCrystalContacts(PDBfile, opts, output_file, chains);
+    }
+
+  // And between the chain copies of the biological assembly
+  if( opts.assembly )
+    {
+      searchAssemblyInterfaces(PDBfile, opts, output_file, chains);
+    }
 }
 
-bool processPDBList(Options& opts)
+bool processPDBList(Options& opts, vector<Query*>& queries)
 {
   // Open the list file
   ifstream listfp(opts.pdblist);
@@ -274,17 +577,6 @@ bool processPDBList(Options& opts)
       return false;
     }
 
-  // Open the output file
-  ofstream output_file(opts.outputfile);
-  if( !output_file )
-    {
-      cerr << red << "Error" << reset << ": Failed to open output file" << endl;
-      perror("\t");
-    }
-
-  // Write the header to output file
-  write_output_head(output_file);
-
   string line;
 
   // Go through each line of the PDB list file
@@ -296,15 +588,14 @@ bool processPDBList(Options& opts)
       cout << purple << line << opts.extension << endl;
 
       // Process the PDB file
-      processSinglePDBFile(filename.c_str(), opts, output_file);
+      processSinglePDBFile(filename.c_str(), opts, queries);
     }
   cout << endl;
-  output_file.close();
   listfp.close();
   return true;
 }
 
-bool processPDBChainList(Options& opts)
+bool processPDBChainList(Options& opts, vector<Query*>& queries)
 {
   // Open up the chain list file
   ifstream listfp(opts.chain_list);
@@ -315,17 +606,6 @@ bool processPDBChainList(Options& opts)
       return false;
     }
 
-  // Open up the output file
-  ofstream output_file(opts.outputfile);
-  if( !output_file )
-    {
-      cerr << red << "Error" << reset << ": Failed to open output file" << endl;
-      perror("\t");
-    }
-
-  // Write the header to the ouput file
-  write_output_head(output_file);
-
   string line;
 
   // Go through each line of the list file
@@ -347,27 +627,19 @@ bool processPDBChainList(Options& opts)
       cout << purple << fields[0] << opts.extension << endl;
 
       // Process the file
-      processSinglePDBFile(filename.c_str(), opts, output_file, fields[1].c_str());
+      processSinglePDBFile(filename.c_str(), opts, queries, fields[1].c_str());
     }
   cout << endl;
-  output_file.close();
   listfp.close();
   return true;
 }
 
-bool processPDBDirectory(Options& opts)
+bool processPDBDirectory(Options& opts, vector<Query*>& queries)
 {
   DIR* directory;
   struct dirent* filename;
   int numberOfFiles;
   int count=0;
-  ofstream output_file(opts.outputfile);
-  if( !output_file )
-    {
-      cerr << red << "Error" << reset << ": Failed to open output file" << endl;
-      perror("\t");
-    }
-  write_output_head(output_file);
 
   // Open the directory for traversal
   if( (directory = opendir( opts.pdbfile )) )
@@ -386,7 +658,7 @@ bool processPDBDirectory(Options& opts)
               sprintf(fullFilePath, "%s/%s", opts.pdbfile, filename->d_name);
 
               // perform some work on the current file
-              processSinglePDBFile(fullFilePath, opts, output_file);
+              processSinglePDBFile(fullFilePath, opts, queries);
             }
         }
     }
@@ -396,17 +668,135 @@ bool processPDBDirectory(Options& opts)
       return false;
     }
   closedir(directory);
-  output_file.close();
   return true;
 }
 
+bool processCandidateFile(Options& opts, vector<Query*>& queries)
+{
+  CandidateReader reader;
+  if( !reader.open(opts.candidatesIn) )
+    {
+      if( reader.version != 0 && reader.version != CANDIDATE_VERSION )
+        {
+          cerr << red << "Error" << reset << ": " << opts.candidatesIn << " is a candidate file of version "
+               << reader.version << ", but this version of STAAR reads version " << CANDIDATE_VERSION << endl;
+        }
+      else
+        {
+          cerr << red << "Error" << reset << ": " << opts.candidatesIn << " is not a candidate file!" << endl;
+        }
+      return false;
+    }
+
+  // Each shard numbers its GAMESS files from 1 in a folder of its own,
+  // x1 to xn the way splitInput lays them out, so that make_scripts and
+  // get_energies.pl find them by number as they do for a run that was
+  // not split up
+  char  shardFolder[1024];
+  char* gamessfolder = opts.gamessfolder;
+  if( opts.gamessfolder && opts.shards > 1 )
+    {
+      sprintf(shardFolder, "%s/x%u", opts.gamessfolder, opts.shard + 1);
+      mkdir(shardFolder, 0755);
+      if( !isDirectory(shardFolder) )
+        {
+          cerr << red << "Error" << reset << ": could not make the GAMESS folder " << shardFolder << " of this shard" << endl;
+          return false;
+        }
+      gamessfolder = shardFolder;
+    }
+
+  // The structures are handed out to the shards in turn, so each one
+  // keeps the pairs of a model together and reuses their hydrogens.
+  // The PDB only points to its file name, so it is kept here rather
+  // than in the reader, which moves on to the next structure's
+  HydrogenCache hydrogenTotals;
+  PDB* structure = NULL;
+  string structureFile;
+  unsigned int structures = 0;
+  unsigned int pairs      = 0;
+  vector<string> residue1;
+  vector<string> residue2;
+  int kind;
+  while( (kind = reader.next()) == CANDIDATE_STRUCTURE || kind == CANDIDATE_PAIR )
+    {
+      if( kind == CANDIDATE_STRUCTURE )
+        {
+          pairQueue.flush();
+          if( structure )
+            {
+              hydrogenTotals.tally(structure->hydrogens);
+              delete structure;
+              structure = NULL;
+            }
+          if( structures++ % opts.shards != opts.shard )
+            {
+              continue;
+            }
+          structure = new PDB();
+          structureFile           = reader.filename;
+          structure->filename     = structureFile.c_str();
+          structure->resolution   = reader.resolution;
+          structure->model_number = reader.model;
+          structure->hydrogens.engine = opts.hydrogens;
+          structure->hydrogens.pool   = babelPool.size() ? &babelPool : NULL;
+          structure->setResiduesToFind(&residue1, &residue2);
+          structure->setLigandsToFind(&residue2);
+          continue;
+        }
+      if( !structure )
+        {
+          continue;
+        }
+
+      PairFinisher finish = findPairFinisher(reader.pair.aa1->residue, reader.pair.aa2->residue);
+      if( !finish )
+        {
+          continue;
+        }
+      // Every name seen so far, since the pairs held are finished later
+      if( find(residue1.begin(), residue1.end(), reader.pair.aa1->residue) == residue1.end() )
+        {
+          residue1.push_back(reader.pair.aa1->residue);
+        }
+      if( find(residue2.begin(), residue2.end(), reader.pair.aa2->residue) == residue2.end() )
+        {
+          residue2.push_back(reader.pair.aa2->residue);
+        }
+      PairContext ctx(reader.threshold, *structure, gamessfolder, queries[0]->output);
+      ctx.minEstimate = minEstimate;
+      pairQueue.add(reader.pair, finish, ctx);
+      pairs++;
+    }
+  pairQueue.flush();
+  if( structure )
+    {
+      hydrogenTotals.tally(structure->hydrogens);
+      delete structure;
+    }
+
+  if( kind == CANDIDATE_ERROR )
+    {
+      cerr << red << "Error" << reset << ": " << opts.candidatesIn << " is cut off or malformed!" << endl;
+    }
+  printHydrogenNotes(hydrogenTotals);
+  cout << gray << "Note" << reset << ": " << pairs << " candidate pairs finished";
+  if( opts.shards > 1 )
+    {
+      cout << " in shard " << opts.shard << "/" << opts.shards;
+    }
+  cout << endl;
+  return kind == CANDIDATE_END;
+}
+
 void searchChainInformation(PDB & PDBfile,
                             unsigned int chain1,
                             unsigned int chain2,
                             string residue1,
                             string residue2,
                             Options & opts,
-                            ofstream& output_file)
+                            ofstream& output_file,
+                            CandidateList& candidates)
 {
 
   Chain* c1 = &(PDBfile.chains[chain1]);
@@ -428,8 +818,18 @@ void searchChainInformation(PDB & PDBfile,
       // let's do some analysis!
       if( c1->aa[i].residue.compare(residue1) == 0 && !(c1->aa[i].skip))
         {
-          for(unsigned int j = 0; j < c2->aa.size(); j++)
-            {              
+          // Only the partners that came within reach need a look
+          vector<Candidate>& partners = candidates[chain1][i];
+          for(unsigned int k = 0; k < partners.size(); k++)
+            {
+              // findBestInteraction makes the real threshold test, this
+              // only has to let everything through that might pass it
+              if( partners[k].ligand || partners[k].chain != chain2 ||
+                  partners[k].distance > opts.threshold )
+                {
+                  continue;
+                }
+              unsigned int j = partners[k].index;
               if(c2->aa[j].residue == residue2 && !(c2->aa[j].skip))
                 {
                   // Find the best interaction out of all the centers
@@ -439,7 +839,6 @@ void searchChainInformation(PDB & PDBfile,
                                        opts.threshold,
                                        PDBfile,
                                        opts.gamessfolder,
-                                       false,
                                        output_file);
                 }
             }
@@ -451,322 +850,827 @@ void searchChainInformation(PDB & PDBfile,
 }
 
 void searchLigandsInformation(PDB & PDBfile,
-                              Residue & ligand,
+                              unsigned int ligand,
                               unsigned int chain1,
                               string residue1,
                               Options & opts,
-                              ofstream& output_file)
+                              ofstream& output_file,
+                              CandidateList& candidates)
 {
   Chain* c1 = &(PDBfile.chains[chain1]);
   for(int i=0; i<c1->aa.size(); i++)
     {
       if(c1->aa[i].residue == residue1 && !(c1->aa[i].skip))
         {
-          findBestInteraction(c1->aa[i],
-                              ligand,
-                              opts.threshold,
-                              PDBfile,
-                              opts.gamessfolder,
-                              true,
-                              output_file);
+          vector<Candidate>& partners = candidates[chain1][i];
+          for(unsigned int k = 0; k < partners.size(); k++)
+            {
+              if( partners[k].ligand && partners[k].chain == ligand &&
+                  partners[k].distance <= opts.threshold )
+                {
+                  findBestInteraction(c1->aa[i],
+                                      *PDBfile.ligands[ligand],
+                                      opts.threshold,
+                                      PDBfile,
+                                      opts.gamessfolder,
+                                      output_file);
+                }
+            }
         }
     }
 }
 
-// Finds the closest distance among all of the centers
-// associated with each amino acid
-double findClosestDistance(AminoAcid& aa1,
-                           AminoAcid& aa2,
-                           float threshold,
-                           unsigned int* closest_index1,
-                           unsigned int* closest_index2)
+// First step: a grid over the representative atoms of the residue2 type
+// residues and the ligands.  A pair can only have centers within reach
+// if the representative atoms are within reach plus both paddings
+void findNearPairs(PDB & PDBfile,
+                   Options & opts,
+                   float reach,
+                   CandidateList& near)
 {
-  double dist;
-  double closest = FLT_MAX;
+  near.clear();
+  near.resize(PDBfile.chains.size());
+
+  vector<Residue*>     partners;
+  vector<Candidate>    templates;
+  vector<Coordinates>  points;
+  float                maxPad = 0;
+  for(unsigned int i=0; i<PDBfile.chains.size(); i++)
+    {
+      near[i].resize(PDBfile.chains[i].aa.size());
+    }
+
+  // The partners go into the grid in search order, so each cell lists
+  // them in that order
+  for(unsigned int s=0; s<PDBfile.searchOrder.size(); s++)
+    {
+      unsigned int i = PDBfile.searchOrder[s].chain;
+      unsigned int j = PDBfile.searchOrder[s].index;
+      Residue* r = &PDBfile.chains[i].aa[j];
+      if( !r->skip && findResidueName(&opts.residue2, r->residue) >= 0 )
+        {
+          Candidate c;
+          c.chain    = i;
+          c.index    = j;
+          c.ligand   = false;
+          c.distance = FLT_MAX;
+          partners.push_back(r);
+          templates.push_back(c);
+        }
+    }
+  for(unsigned int i=0; i<PDBfile.ligands.size(); i++)
+    {
+      if( !PDBfile.ligands[i]->skip )
+        {
+          Candidate c;
+          c.chain    = i;
+          c.index    = 0;
+          c.ligand   = true;
+          c.distance = FLT_MAX;
+          partners.push_back(PDBfile.ligands[i]);
+          templates.push_back(c);
+        }
+    }
+  for(unsigned int i=0; i<partners.size(); i++)
+    {
+      if( !partners[i]->representative )
+        {
+          partners[i]->setRepresentative();
+        }
+      points.push_back(partners[i]->representative->coord);
+      maxPad = max(maxPad, partners[i]->pad);
+    }
+  NeighborGrid grid;
+  grid.build(points, reach + 2*maxPad);
+  if( grid.empty() )
+    {
+      return;
+    }
 
-  // Go through all combination of distances looking
-  // for the closet pair
-  for( unsigned int i = 0; i < aa1.center.size(); i++ )
+  // Consecutive queries land in the same or nearby cells
+  vector<unsigned int> found;
+  for(unsigned int s=0; s<PDBfile.searchOrder.size(); s++)
     {
-      if(aa1.center[i].skip) continue;
-      for( unsigned int j = 0; j < aa2.center.size(); j++ )
+      unsigned int i = PDBfile.searchOrder[s].chain;
+      unsigned int j = PDBfile.searchOrder[s].index;
+      Residue* r = &PDBfile.chains[i].aa[j];
+      if( r->skip || findResidueName(&opts.residue1, r->residue) < 0 )
         {
-          if(aa2.center[j].skip) continue;
-          dist = aa1.center[i].distance(aa2.center[j]);
-          // flag it if is the closest and within the threshold
-          if( dist < closest && dist < threshold )
+          continue;
+        }
+      if( !r->representative )
+        {
+          r->setRepresentative();
+        }
+      Coordinates& rep1 = r->representative->coord;
+
+      found.clear();
+      grid.query(rep1, reach + r->pad + maxPad, found);
+      for(unsigned int k=0; k<found.size(); k++)
+        {
+          Residue* partner = partners[found[k]];
+          if( rep1.distance(partner->representative->coord) < reach + r->pad + partner->pad )
             {
-              *closest_index1 = i;
-              *closest_index2 = j;
-              closest = dist;
+              near[i][j].push_back(templates[found[k]]);
             }
         }
+      sort(near[i][j].begin(), near[i][j].end());
     }
-  return closest;
 }
 
-void findBestInteraction( AminoAcid& aa1,
-                          AminoAcid& aa2,
-                          float threshold,
-                          PDB & PDBfile,
-                          char* gamessfolder,
-                          bool ligand,
-                          ofstream& output_file)
+// Second step: only the residues that made it through the first one get
+// their centers calculated, and those are checked against the threshold
+void checkNearPairs(PDB & PDBfile,
+                    Options & opts,
+                    CandidateList& near,
+                    CandidateList& candidates)
+{
+  candidates.clear();
+  candidates.resize(near.size());
+
+  // All of the near pairs go through the distance kernel in one batch
+  DistanceBatch batch;
+  vector<Candidate*> queued;
+  vector<unsigned int> owner1, owner2;
+  for(unsigned int i=0; i<near.size(); i++)
+    {
+      candidates[i].resize(near[i].size());
+    }
+  for(unsigned int s=0; s<PDBfile.searchOrder.size(); s++)
+    {
+      unsigned int i = PDBfile.searchOrder[s].chain;
+      unsigned int j = PDBfile.searchOrder[s].index;
+      Residue* r = &PDBfile.chains[i].aa[j];
+      for(unsigned int k=0; k<near[i][j].size(); k++)
+        {
+          Candidate& c = near[i][j][k];
+          Residue* partner = c.ligand ? PDBfile.ligands[c.chain] : &PDBfile.chains[c.chain].aa[c.index];
+
+          // Now the centers are needed
+          r->ensureCenter();
+          partner->ensureCenter();
+          if( r->skip )
+            {
+              break;
+            }
+          if( partner->skip )
+            {
+              continue;
+            }
+          addClosestCombinations(*r, *partner, opts.threshold);
+          batch.add(*r, *partner);
+          queued.push_back(&c);
+          owner1.push_back(i);
+          owner2.push_back(j);
+        }
+    }
+  batch.run(opts.threshold);
+
+  // The partners of each residue are queued in their chain order, so
+  // the candidates stay sorted whatever order the residues came in
+  for(unsigned int k=0; k<queued.size(); k++)
+    {
+      if( batch.closest[k] != FLT_MAX )
+        {
+          Candidate c = *queued[k];
+          c.distance = batch.closest[k];
+          candidates[owner1[k]][owner2[k]].push_back(c);
+        }
+    }
+
+#ifdef DEBUG
+  unsigned int numResidues = 0;
+  unsigned int numCentered = 0;
+  for(unsigned int i=0; i<PDBfile.chains.size(); i++)
+    {
+      for(unsigned int j=0; j<PDBfile.chains[i].aa.size(); j++)
+        {
+          if( PDBfile.chains[i].aa[j].representative )
+            {
+              numResidues++;
+              numCentered += PDBfile.chains[i].aa[j].centered;
+            }
+        }
+    }
+  cout << purple << "Centers calculated for " << numCentered << " of " << numResidues << " residues" << endl;
+#endif
+}
+
+void findCandidates(PDB & PDBfile,
+                    Options & opts,
+                    CandidateList& candidates)
 {
-  float closestDist = FLT_MAX;
-  unsigned int closestDist_index1 = 0;
-  unsigned int closestDist_index2 = 0;
-  float dist;
-  float angle;
-  float angle1;
-  float angleP;
-  float angleh;
-  float angleOxy;
-  float angleOxy2;
-  AminoAcid aa1h;
-  AminoAcid aa2h;
-  char output_filename[1024] = "N/A";
-  static int numOutputted = 0;
-
-  // Go through all combination of distances looking
-  // for the closet pair
-  closestDist = findClosestDistance(aa1,
-                                    aa2,
-                                    threshold,
-                                    &closestDist_index1,
-                                    &closestDist_index2);
-
-  // AND WE HAVE A WINNER! 
-  // if we found something output it to the file,
-  // add hydrogens, and try the process again
-  if( closestDist != FLT_MAX )
-    {
-      // Just some codes that were in the original STAAR
-      char code1 = 'I';
-      if( aa1.atom[0]->chainID != aa2.atom[0]->chainID )
-        code1 = 'X';
-      char code2 = 'S';
-      //if( aa1.center.size() > 1 || aa2.center.size() > 1 )
-      if( aa1.altLoc || aa2.altLoc )
-        {
-          code2 = 'M';
-        }
-
-      PDB pairWithHydrogen;
-
-      // Set the residues and ligands to find
-      pairWithHydrogen.setResiduesToFind(PDBfile.residue1, PDBfile.residue2);
-      pairWithHydrogen.setLigandsToFind(PDBfile.ligandsToFind);
-      
-
-      // Add the hydrogens
-      pairWithHydrogen.addHydrogensToPair(aa1,aa2,closestDist_index1,closestDist_index2);
-
-      // Set the filename
-      pairWithHydrogen.filename = PDBfile.filename;
-
-      // Separate the pair into 2 variables
-      pairWithHydrogen.getPair(aa1.atom[0]->resSeq,
-                               aa2.atom[0]->resSeq,
-                               &aa1h,
-                               &aa2h,
-                               ligand);
-
-      if( aa2h.skip == true || aa1h.skip == true )
-        {
-          return;
-        }
-
-      float dist;
-      float distOxy;
-      float distOxy2;
-      if(!aa1h.calculateDistancesAndAnglesPostHydrogens(aa2h,
-                                                        aa2.center[closestDist_index2],
-                                                        threshold,
-                                                        &dist,
-                                                        &distOxy,
-                                                        &distOxy2,
-                                                        &angleh,
-                                                        &angleOxy,
-                                                        &angleOxy2))
-        {
-          return;
-        }
-
-      // calculate the angles of this interaction
-      aa1.calculateAnglesPreHydrogens(aa2,
-                                      closestDist_index1,
-                                      closestDist_index2,
-                                      &angle,
-                                      &angle1,
-                                      &angleP);
-
-      // The following is pretty hackish.  For the time being since we don't
-      // have an agreement on how to deal with the PO4 ligands completely, 
-      // we will take 1 H out at a time and output the GAMESS input file.
-      // Thus, for each PO4, we will have 3 GAMESS input files.
-      // Good thing there aren't too many of these
-      if(aa2h.residue == "PO4")
-        {
-          vector<Atom*>::iterator atom_iterator;
-          int count = 0;
-          for( atom_iterator  = aa2h.atom.begin();
-               atom_iterator != aa2h.atom.end();
-               ++atom_iterator )
+  CandidateList near;
+  findNearPairs(PDBfile, opts, distanceReach(opts.threshold), near);
+  checkNearPairs(PDBfile, opts, near, candidates);
+}
+
+// The residues the Verlet list keeps track of: the residue1 and residue2
+// types and the ligands, in chain order
+static void trackedResidues(PDB & PDBfile,
+                            Options & opts,
+                            vector<Residue*>& tracked)
+{
+  tracked.clear();
+  for(unsigned int i=0; i<PDBfile.chains.size(); i++)
+    {
+      for(unsigned int j=0; j<PDBfile.chains[i].aa.size(); j++)
+        {
+          Residue* r = &PDBfile.chains[i].aa[j];
+          if( !r->skip && ( findResidueName(&opts.residue1, r->residue) >= 0 ||
+                            findResidueName(&opts.residue2, r->residue) >= 0 ) )
             {
-              if((*atom_iterator)->name == " H  ")
-                {
-                  (*atom_iterator)->skip = true;
-                  if( gamessfolder )
-                    {
-                      numOutputted++;
-                      sprintf(output_filename, "%s/gamessinp-%d.inp", gamessfolder, numOutputted);
-                      outputINPfile(PDBfile.filename, output_filename, aa1h, aa2h);
-                    }
-                  else
-                    {
-                      sprintf(output_filename, "N/A");
-                    }
+              tracked.push_back(r);
+            }
+        }
+    }
+  for(unsigned int i=0; i<PDBfile.ligands.size(); i++)
+    {
+      if( !PDBfile.ligands[i]->skip )
+        {
+          tracked.push_back(PDBfile.ligands[i]);
+        }
+    }
+  for(unsigned int i=0; i<tracked.size(); i++)
+    {
+      if( !tracked[i]->representative )
+        {
+          tracked[i]->setRepresentative();
+        }
+    }
+}
 
-                  // and we finally output some results!
-                  output_file << aa1.residue                        << ","
-                              << aa2.residue                        << ","
-                              << closestDist                        << ","
-                              << angle                              << ","
-                              << angleP                             << ","
-                              << angle1                             << ","
-                              << aa1.atom[0]->resSeq                << ","
-                              << aa2.atom[0]->resSeq                << ","
-                              << code1 << code2                     << ","
-                              << PDBfile.filename                   << ","
-                              << PDBfile.resolution                 << ","
-                              << output_filename                    << ","
-                              << aa1.atom[0]->chainID               << ","
-                              << aa2.atom[0]->chainID               << ","
-                              << aa1.center[closestDist_index1]     << ","
-                              << aa2.center[closestDist_index2]     << ","
-                              << aa1h.center[0]                     << ","
-                              << aa2h.center[0]                     << ","
-                              << dist                               << ","
-                              << distOxy                            << ","
-                              << distOxy2                           << ","
-                              << angleh                             << ","
-                              << angleOxy                           << ","
-                              << angleOxy2                          << endl;
-                  (*atom_iterator)->skip = false;
-                  if(count == 2) break;
-                  ++count;
-                }
+VerletList::VerletList()
+{
+  valid    = false;
+  skin     = 0;
+  rebuilds = 0;
+  reuses   = 0;
+}
+
+// The list built at threshold + skin stays good as long as no residue
+// has drifted by more than skin/2, where the drift is how far the
+// representative atom moved plus how much the padding grew, since two
+// residues that were left out then can not have come within the
+// threshold.  The residues also have to be the same ones as before
+void findCandidatesVerlet(PDB & PDBfile,
+                          Options & opts,
+                          VerletList& verlet,
+                          CandidateList& candidates)
+{
+  vector<Residue*> tracked;
+  trackedResidues(PDBfile, opts, tracked);
+
+  bool reuse = verlet.valid && tracked.size() == verlet.reference.size();
+  for(unsigned int i=0; i<tracked.size() && reuse; i++)
+    {
+      reuse = tracked[i]->residue == verlet.names[i] &&
+              tracked[i]->atom[0]->resSeq == verlet.resSeqs[i];
+      if( reuse )
+        {
+          float drift = tracked[i]->representative->coord.distance(verlet.reference[i]) +
+                        max(0.0f, tracked[i]->pad - verlet.pads[i]);
+          reuse = drift <= verlet.skin / 2;
+        }
+    }
+
+  if( !reuse )
+    {
+      findNearPairs(PDBfile, opts, distanceReach(opts.threshold) + verlet.skin, verlet.pairs);
+      verlet.reference.resize(tracked.size());
+      verlet.pads.resize(tracked.size());
+      verlet.names.resize(tracked.size());
+      verlet.resSeqs.resize(tracked.size());
+      for(unsigned int i=0; i<tracked.size(); i++)
+        {
+          verlet.reference[i] = tracked[i]->representative->coord;
+          verlet.pads[i]      = tracked[i]->pad;
+          verlet.names[i]     = tracked[i]->residue;
+          verlet.resSeqs[i]   = tracked[i]->atom[0]->resSeq;
+        }
+      verlet.valid = true;
+      verlet.rebuilds++;
+    }
+  else
+    {
+      verlet.reuses++;
+    }
+  checkNearPairs(PDBfile, opts, verlet.pairs, candidates);
+}
+
+// Returns the index of name in list, or -1 if it isn't there
+static int findResidueName(vector<string>* list, string& name)
+{
+  if( !list )
+    {
+      return -1;
+    }
+  for(unsigned int i=0; i<list->size(); i++)
+    {
+      if( (*list)[i] == name )
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+// Gathers the residues taking part in a search where the second group
+// gets moved by an operator.  The first group holds the residue1 types
+// (only from the chains listed in chains, if any) and the second one the
+// residue2 types and the ligands.  If only is not negative, just the
+// residues of that chain are gathered
+static void gatherResidues(PDB & PDBfile,
+                           Options & opts,
+                           const char* chains,
+                           int only,
+                           vector<Residue*>& group1,
+                           vector<Residue*>& group2)
+{
+  for(unsigned int i=0; i<PDBfile.chains.size(); i++)
+    {
+      if( only >= 0 && (unsigned int)only != i )
+        {
+          continue;
+        }
+      bool wanted = !chains || strchr(chains, PDBfile.chains[i].id);
+      for(unsigned int j=0; j<PDBfile.chains[i].aa.size(); j++)
+        {
+          Residue* r = &PDBfile.chains[i].aa[j];
+          bool type1 = wanted && findResidueName(&opts.residue1, r->residue) >= 0;
+          bool type2 = findResidueName(&opts.residue2, r->residue) >= 0;
+          if( !r->skip && (type1 || type2) )
+            {
+              r->ensureCenter();
             }
+          if( r->skip )
+            {
+              continue;
+            }
+          if( type1 )
+            {
+              group1.push_back(r);
+            }
+          if( type2 )
+            {
+              group2.push_back(r);
+            }
+        }
+    }
+  for(unsigned int i=0; i<PDBfile.ligands.size(); i++)
+    {
+      if( PDBfile.ligands[i]->skip )
+        {
+          continue;
         }
-      else 
+      if( only >= 0 && PDBfile.ligands[i]->atom[0]->chainID != PDBfile.chains[only].id )
         {
-          // Here, we are outputting the
-          if( gamessfolder )
+          continue;
+        }
+      group2.push_back(PDBfile.ligands[i]);
+    }
+}
+
+// Largest spread of the alternate location combinations in group that
+// have not been built.  The grids and boxes below are over the centers
+// that have been, so they have to look this much further
+static float groupSpread(vector<Residue*>& group)
+{
+  float spread = 0;
+  for(unsigned int i=0; i<group.size(); i++)
+    {
+      spread = fmax(spread, group[i]->spread);
+    }
+  return spread;
+}
+
+// Builds a grid over the centers of group.  owner tells which residue
+// of group each grid point came from
+static void buildCenterGrid(vector<Residue*>& group,
+                            float threshold,
+                            NeighborGrid& grid,
+                            vector<unsigned int>& owner)
+{
+  vector<Coordinates> points;
+  owner.clear();
+  for(unsigned int i=0; i<group.size(); i++)
+    {
+      for(unsigned int j=0; j<group[i]->center.size(); j++)
+        {
+          if( group[i]->center[j].skip ) continue;
+          points.push_back(group[i]->center[j]);
+          owner.push_back(i);
+        }
+    }
+  grid.build(points, threshold);
+}
+
+// Looks for interactions between group1, left where it is, and every
+// residue of group2 moved by op.  The grid must have been built over
+// group1.  code replaces the I/X code in the output and label says
+// where op came from in the notes
+static void searchMovedGroup(PDB & PDBfile,
+                             Options & opts,
+                             NeighborGrid& grid,
+                             vector<unsigned int>& owner,
+                             vector<Residue*>& group1,
+                             vector<Residue*>& group2,
+                             const Transform& op,
+                             char code,
+                             const string& label,
+                             ofstream& output_file)
+{
+  vector<unsigned int> found;
+  vector<unsigned int> partners;
+  vector<Atom>         imageAtoms;
+  Residue              image;
+  float                spread1 = groupSpread(group1);
+  for(unsigned int i=0; i<group2.size(); i++)
+    {
+      // Look up every moved center of this residue in the grid
+      found.clear();
+      for(unsigned int j=0; j<group2[i]->center.size(); j++)
+        {
+          if( group2[i]->center[j].skip ) continue;
+          grid.query(op.apply(group2[i]->center[j]),
+                     distanceReach(opts.threshold) + spread1 + group2[i]->spread, found);
+        }
+      if( found.empty() )
+        {
+          continue;
+        }
+      partners.clear();
+      for(unsigned int j=0; j<found.size(); j++)
+        {
+          partners.push_back(owner[found[j]]);
+        }
+      sort(partners.begin(), partners.end());
+      partners.erase(unique(partners.begin(), partners.end()), partners.end());
+
+      bool made = false;
+      for(unsigned int j=0; j<partners.size(); j++)
+        {
+          Residue* r1 = group1[partners[j]];
+          Residue* r2 = group2[i];
+          if( opts.sameChain && r1->atom[0]->chainID != r2->atom[0]->chainID )
             {
-              numOutputted++;
-              sprintf(output_filename, "%s/gamessinp-%d.inp", gamessfolder, numOutputted);
-              outputINPfile(PDBfile.filename, output_filename, aa1h, aa2h);
+              continue;
             }
-          else
+          // A residue next to its own copy would be merged
+          // with it once the pair is handed to Babel
+          if( r1->atom[0]->chainID == r2->atom[0]->chainID &&
+              r1->atom[0]->resSeq  == r2->atom[0]->resSeq )
             {
-              sprintf(output_filename, "N/A");
+              continue;
             }
 
-          // and we finally output some results!
-          output_file << aa1.residue                        << ","
-                      << aa2.residue                        << ","
-                      << closestDist                        << ","
-                      << angle                              << ","
-                      << angleP                             << ","
-                      << angle1                             << ","
-                      << aa1.atom[0]->resSeq                << ","
-                      << aa2.atom[0]->resSeq                << ","
-                      << code1 << code2                     << ","
-                      << PDBfile.filename                   << ","
-                      << PDBfile.resolution                 << ","
-                      << PDBfile.model_number               << ","
-                      << output_filename                    << ","
-                      << aa1.atom[0]->chainID               << ","
-                      << aa2.atom[0]->chainID               << ","
-                      << aa1.center[closestDist_index1]     << ","
-                      << aa2.center[closestDist_index2]     << ","
-                      << aa1h.center[0]                     << ","
-                      << aa2h.center[0]                     << ","
-                      << dist                               << ","
-                      << distOxy                            << ","
-                      << distOxy2                           << ","
-                      << angleh                             << ","
-                      << angleOxy                           << ","
-                      << angleOxy2                          << endl;
+          unsigned int index1, index2;
+          if( findClosestDistance(*r1, *r2, op, opts.threshold, &index1, &index2) == FLT_MAX )
+            {
+              continue;
+            }
+
+          // Now it is worth making the moved copy
+          if( !made )
+            {
+              // The pairs held with the copy before it are done with it
+              pairQueue.flush();
+              makeImageResidue(*r2, op, imageAtoms, &image);
+              made = true;
+              cout << gray << "Note" << reset << ": contact with "
+                   << r2->residue << r2->atom[0]->resSeq << " chain " << r2->atom[0]->chainID
+                   << " through " << label << endl;
+            }
+          if( image.skip )
+            {
+              break;
+            }
+          findBestInteraction(*r1,
+                              image,
+                              opts.threshold,
+                              PDBfile,
+                              opts.gamessfolder,
+                              output_file,
+                              code);
         }
+    }
+  pairQueue.flush();
+}
 
+// Crystal contacts.  The images are never stored: their centers are
+// moved on the fly while looking them up in a grid built over the
+// asymmetric unit, and only the lattice translations that can put an
+// image within the threshold of the asymmetric unit are visited.  A
+// residue is only copied (and moved) once it is known to be part of an
+// interaction, because Babel needs real coordinates to add hydrogens.
+void searchCrystalContacts(PDB & PDBfile,
+                           Options & opts,
+                           ofstream& output_file,
+                           const char* chains)
+{
+  if( !PDBfile.cell.valid || PDBfile.symmetry.empty() )
+    {
+      cout << gray << "Note" << reset << ": no usable CRYST1/SMTRY records. Skipping crystal contacts." << endl;
+      return;
     }
+
+  // Gather the residues that take part in the search.  The first group
+  // stays in the asymmetric unit, the second one gets moved around
+  vector<Residue*> group1;
+  vector<Residue*> group2;
+  gatherResidues(PDBfile, opts, chains, -1, group1, group2);
+  if( group1.empty() || group2.empty() )
+    {
+      return;
+    }
+
+  // Grid over the centers of the first group along with the box
+  // that the first group takes up in fractional coordinates
+  NeighborGrid         grid;
+  vector<unsigned int> owner;
+  buildCenterGrid(group1, distanceReach(opts.threshold), grid, owner);
+  if( grid.empty() )
+    {
+      return;
+    }
+  Coordinates fracLower( FLT_MAX,  FLT_MAX,  FLT_MAX);
+  Coordinates fracUpper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  for(unsigned int i=0; i<group1.size(); i++)
+    {
+      for(unsigned int j=0; j<group1[i]->center.size(); j++)
+        {
+          if( group1[i]->center[j].skip ) continue;
+          Coordinates f = PDBfile.cell.toFractional(group1[i]->center[j]);
+          fracLower.set(fmin(fracLower.x, f.x), fmin(fracLower.y, f.y), fmin(fracLower.z, f.z));
+          fracUpper.set(fmax(fracUpper.x, f.x), fmax(fracUpper.y, f.y), fmax(fracUpper.z, f.z));
+        }
+    }
+
+  float reach[3];
+  PDBfile.cell.fractionalReach(distanceReach(opts.threshold) + groupSpread(group1) + groupSpread(group2), reach);
+
+  unsigned int visited = 0;
+  for(unsigned int k=0; k<PDBfile.symmetry.size(); k++)
+    {
+      Transform& op = PDBfile.symmetry[k];
+
+      // Box of the second group after this operator (without any
+      // lattice translation) in fractional coordinates
+      Coordinates imageLower( FLT_MAX,  FLT_MAX,  FLT_MAX);
+      Coordinates imageUpper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+      for(unsigned int i=0; i<group2.size(); i++)
+        {
+          for(unsigned int j=0; j<group2[i]->center.size(); j++)
+            {
+              if( group2[i]->center[j].skip ) continue;
+              Coordinates f = PDBfile.cell.toFractional(op.apply(group2[i]->center[j]));
+              imageLower.set(fmin(imageLower.x, f.x), fmin(imageLower.y, f.y), fmin(imageLower.z, f.z));
+              imageUpper.set(fmax(imageUpper.x, f.x), fmax(imageUpper.y, f.y), fmax(imageUpper.z, f.z));
+            }
+        }
+      if( imageLower.x == FLT_MAX )
+        {
+          continue;
+        }
+
+      // Only the cells whose shifted box comes within the threshold
+      // of the asymmetric unit can hold a contact
+      int lo[3], hi[3];
+      lo[0] = (int)ceil (fracLower.x - imageUpper.x - reach[0]);
+      hi[0] = (int)floor(fracUpper.x - imageLower.x + reach[0]);
+      lo[1] = (int)ceil (fracLower.y - imageUpper.y - reach[1]);
+      hi[1] = (int)floor(fracUpper.y - imageLower.y + reach[1]);
+      lo[2] = (int)ceil (fracLower.z - imageUpper.z - reach[2]);
+      hi[2] = (int)floor(fracUpper.z - imageLower.z + reach[2]);
+
+      for(int na=lo[0]; na<=hi[0]; na++)
+        {
+          for(int nb=lo[1]; nb<=hi[1]; nb++)
+            {
+              for(int nc=lo[2]; nc<=hi[2]; nc++)
+                {
+                  // This one is just the asymmetric unit itself
+                  if( na == 0 && nb == 0 && nc == 0 && op.isIdentity() )
+                    {
+                      continue;
+                    }
+                  visited++;
+                  Transform cellOp = PDBfile.cell.latticeShift(na, nb, nc) * op;
+
+                  ostringstream label;
+                  label << "SMTRY " << op.serial << " + (" << na << "," << nb << "," << nc << ")";
+                  searchMovedGroup(PDBfile, opts, grid, owner, group1, group2,
+                                   cellOp, 'C', label.str(), output_file);
+                }
+            }
+        }
+    }
+#ifdef DEBUG
+  cout << purple << "Visited " << visited << " image cells" << endl;
+#endif
 }
 
-void outputINPfile(string input_filename, char* filename, AminoAcid& aa1h, AminoAcid& aa2h)
+// Smallest sphere around the center of the box holding every center of
+// group.  Returns false if there are no centers
+static bool boundingSphere(vector<Residue*>& group,
+                           Coordinates& middle,
+                           float& radius)
 {
-  ofstream inpout(filename);
+  Coordinates lower( FLT_MAX,  FLT_MAX,  FLT_MAX);
+  Coordinates upper(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  for(unsigned int i=0; i<group.size(); i++)
+    {
+      for(unsigned int j=0; j<group[i]->center.size(); j++)
+        {
+          Coordinates& c = group[i]->center[j];
+          if( c.skip ) continue;
+          lower.set(fmin(lower.x, c.x), fmin(lower.y, c.y), fmin(lower.z, c.z));
+          upper.set(fmax(upper.x, c.x), fmax(upper.y, c.y), fmax(upper.z, c.z));
+        }
+    }
+  if( lower.x == FLT_MAX )
+    {
+      return false;
+    }
+  middle = (lower + upper) / 2.0;
+  radius = 0;
+  for(unsigned int i=0; i<group.size(); i++)
+    {
+      for(unsigned int j=0; j<group[i]->center.size(); j++)
+        {
+          if( group[i]->center[j].skip ) continue;
+          radius = fmax(radius, middle.distance(group[i]->center[j]) + group[i]->spread);
+        }
+    }
+  return true;
+}
 
-  inpout << INPheader << endl;
-  inpout << " $MOROKM IATM(1)=" << aa1h.atom.size() << ",";
-  if(aa2h.residue == "PO4")
+// Biological assembly interfaces.  Every copy of a chain in the assembly
+// is a (chain, operator) instance over the deposited coordinates.  Two
+// instance pairs with the same chains and the same relative operator
+// Ti^-1 * Tj are the same interface moved somewhere else, so each
+// relative operator is only searched once per ordered chain pair.  The
+// relative operators that are the identity are left out since those
+// pairs were already looked at in the deposited coordinates.
+void searchAssemblyInterfaces(PDB & PDBfile,
+                              Options & opts,
+                              ofstream& output_file,
+                              const char* chains)
+{
+  Biomolecule* biomolecule = NULL;
+  for(unsigned int i=0; i<PDBfile.assemblies.size(); i++)
     {
-      inpout<< aa2h.atom.size() - 1 << " ICHM(1)=0,-1" << " $END" << endl;
+      if( PDBfile.assemblies[i].number == opts.assembly )
+        {
+          biomolecule = &PDBfile.assemblies[i];
+          break;
+        }
     }
-  else
+  if( !biomolecule )
     {
-      inpout<< aa2h.atom.size() << " ICHM(1)=0,-1" << " $END" << endl;
+      cout << gray << "Note" << reset << ": no REMARK 350 biomolecule " << opts.assembly << ". Skipping assembly interfaces." << endl;
+      return;
     }
-  inpout << " $DATA" << endl;
-  inpout << input_filename << endl;
-  inpout << "C1" << endl;
-  for(int i=0; i<aa1h.atom.size(); i++)
+
+  // Lay out the chain instances
+  vector<ChainInstance> instances;
+  for(unsigned int g=0; g<biomolecule->groups.size(); g++)
     {
-      if( aa1h.atom[i]->element == " H" )
+      AssemblyGroup& group = biomolecule->groups[g];
+      for(unsigned int c=0; c<group.chains.size(); c++)
         {
-          inpout << "H      1.0     ";
+          for(unsigned int i=0; i<PDBfile.chains.size(); i++)
+            {
+              if( PDBfile.chains[i].id != group.chains[c] )
+                {
+                  continue;
+                }
+              for(unsigned int k=0; k<group.ops.size(); k++)
+                {
+                  ChainInstance instance;
+                  instance.chain = i;
+                  instance.op    = group.ops[k];
+                  instances.push_back(instance);
+                }
+            }
         }
-      else if( aa1h.atom[i]->element == " C")
+    }
+  if( instances.size() < 2 )
+    {
+      return;
+    }
+
+  // The residues, grids, and bounding spheres of every chain
+  unsigned int numChains = PDBfile.chains.size();
+  vector< vector<Residue*> >     group1(numChains);
+  vector< vector<Residue*> >     group2(numChains);
+  vector< vector<unsigned int> > owner(numChains);
+  vector<NeighborGrid>           grid(numChains);
+  vector<Coordinates>            middle1(numChains), middle2(numChains);
+  vector<float>                  radius1(numChains, -1), radius2(numChains, -1);
+  for(unsigned int i=0; i<numChains; i++)
+    {
+      gatherResidues(PDBfile, opts, chains, i, group1[i], group2[i]);
+      buildCenterGrid(group1[i], distanceReach(opts.threshold), grid[i], owner[i]);
+      if( !boundingSphere(group1[i], middle1[i], radius1[i]) )
         {
-          inpout << "C      6.0     ";
+          radius1[i] = -1;
         }
-      else if( aa1h.atom[i]->element == " O")
+      if( !boundingSphere(group2[i], middle2[i], radius2[i]) )
         {
-          inpout << "O      8.0     ";
+          radius2[i] = -1;
         }
-      inpout << aa1h.atom[i]->coord << endl;
     }
 
-  for(int i=0; i<aa2h.atom.size(); i++)
+  // Keep only the symmetry-unique relative operators
+  vector<unsigned int> uniqueChain1;
+  vector<unsigned int> uniqueChain2;
+  vector<Transform>    uniqueOp;
+  vector<string>       uniqueLabel;
+  for(unsigned int i=0; i<instances.size(); i++)
     {
-      if( !aa2h.atom[i]->skip )
+      Transform inverse = instances[i].op.inverse();
+      for(unsigned int j=0; j<instances.size(); j++)
         {
-          if( aa2h.atom[i]->element == " H")
+          if( i == j )
+            {
+              continue;
+            }
+          unsigned int c1 = instances[i].chain;
+          unsigned int c2 = instances[j].chain;
+          if( radius1[c1] < 0 || radius2[c2] < 0 )
             {
-              inpout << "H      1.0     ";
+              continue;
             }
-          else if( aa2h.atom[i]->element == " C")
+          Transform relative = inverse * instances[j].op;
+          if( relative.isIdentity() )
             {
-              inpout << "C      6.0     ";
+              continue;
             }
-          else if( aa2h.atom[i]->element == " O")
+          bool seen = false;
+          for(unsigned int k=0; k<uniqueOp.size() && !seen; k++)
             {
-              inpout << "O      8.0     ";
+              seen = uniqueChain1[k] == c1 && uniqueChain2[k] == c2 && uniqueOp[k].equals(relative);
             }
-          else if( aa2h.atom[i]->element == " P")
+          if( seen )
             {
-              inpout << "P     15.0     ";
+              continue;
             }
-          inpout << aa2h.atom[i]->coord << endl;
+          uniqueChain1.push_back(c1);
+          uniqueChain2.push_back(c2);
+          uniqueOp.push_back(relative);
+          ostringstream label;
+          label << "BIOMT " << instances[i].op.serial << " -> " << instances[j].op.serial;
+          uniqueLabel.push_back(label.str());
         }
     }
 
-  inpout << " $END" << endl;
-  inpout.close();
+  cout << gray << "Note" << reset << ": biomolecule " << opts.assembly << " has "
+       << instances.size() << " chain copies and " << uniqueOp.size() << " unique interfaces" << endl;
+
+  for(unsigned int k=0; k<uniqueOp.size(); k++)
+    {
+      unsigned int c1 = uniqueChain1[k];
+      unsigned int c2 = uniqueChain2[k];
+      if( grid[c1].empty() )
+        {
+          continue;
+        }
+      // The two chains can not come within the threshold of each other
+      Coordinates moved = uniqueOp[k].apply(middle2[c2]);
+      if( middle1[c1].distance(moved) > radius1[c1] + radius2[c2] + distanceReach(opts.threshold) )
+        {
+          continue;
+        }
+      searchMovedGroup(PDBfile, opts, grid[c1], owner[c1], group1[c1], group2[c2],
+                       uniqueOp[k], 'B', uniqueLabel[k], output_file);
+    }
+}
+
+void findBestInteraction( AminoAcid& aa1,
+                          AminoAcid& aa2,
+                          float threshold,
+                          PDB & PDBfile,
+                          char* gamessfolder,
+                          ofstream& output_file,
+                          char contact)
+{
+  PairKernel kernel = pairKernels.find(aa1.residue, aa2.residue);
+  if( !kernel )
+    {
+      return;
+    }
+  PairContext ctx(threshold, PDBfile, gamessfolder, output_file, contact);
+  if( candidateWriter.isOpen() )
+    {
+      ctx.candidates = &candidateWriter;
+    }
+  ctx.queue       = &pairQueue;
+  ctx.minEstimate = minEstimate;
+  kernel(aa1, aa2, ctx);
 }
 
 void write_output_head(ofstream& out)
 {
-  out <<"#res1,res2,dist,angle,angleP,angle1,loc1,loc2,code,pdbID,resolution,model,gamessinput,chain1,chain2,center1,,,center2,,,center1h,,,center2h,,,dist,distOxy,distOxy2,angleh,angleOxy,angleOxy2,gamessoutput,electrostatic(Hartree),electrostatic(kcal/mol),exchangerep(Hartree),exchangerep(kcal/mole),polarization(Hartree),polarization(kcal/mole),chargexfer(Hartree),chargexfer(kcal/mol),highordercoup(Hartree),highordercoup(kcal/mole),totalinter(Hartree),totalinter(kcal/mole)" << endl;
+  out <<"#res1,res2,dist,angle,angleP,angle1,loc1,loc2,code,pdbID,resolution,model,gamessinput,chain1,chain2,center1,,,center2,,,center1h,,,center2h,,,dist,distOxy,distOxy2,angleh,angleOxy,angleOxy2,estimate(kcal/mol),gamessoutput,electrostatic(Hartree),electrostatic(kcal/mol),exchangerep(Hartree),exchangerep(kcal/mole),polarization(Hartree),polarization(kcal/mole),chargexfer(Hartree),chargexfer(kcal/mol),highordercoup(Hartree),highordercoup(kcal/mole),totalinter(Hartree),totalinter(kcal/mole)" << endl;
 }